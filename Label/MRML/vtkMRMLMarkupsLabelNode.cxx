@@ -46,3 +46,15 @@ void vtkMRMLMarkupsLabelNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os,indent);
 }
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsLabelNode::SetLabel(QString label)
+{
+  if (this->Label == label)
+  {
+    return;
+  }
+  this->Label = label;
+  this->LabelText = label.toStdString();
+  this->Modified();
+}
@@ -27,6 +27,8 @@
 
 #include <QString>
 
+#include <string>
+
 //-----------------------------------------------------------------------------
 class VTK_SLICER_LABEL_MODULE_MRML_EXPORT vtkMRMLMarkupsLabelNode
 : public vtkMRMLMarkupsNode
@@ -61,7 +63,9 @@ public:
   vtkMRMLCopyContentDefaultMacro(vtkMRMLMarkupsLabelNode);
   
   vtkGetMacro(Label, QString);
-  vtkSetMacro(Label, QString);
+  void SetLabel(QString label);
+  /// Label in UTF-8, converted once when it is set.
+  const char * GetLabelText() { return this->LabelText.c_str(); }
 
 protected:
   vtkMRMLMarkupsLabelNode();
@@ -70,6 +74,7 @@ protected:
   void operator=(const vtkMRMLMarkupsLabelNode&);
   
   QString Label = "Label";
+  std::string LabelText = "Label";
 
 private:
   
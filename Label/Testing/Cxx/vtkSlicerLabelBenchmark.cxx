@@ -0,0 +1,164 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+/*
+ * Times the Label representations on a generated scene.
+ *
+ * Arguments, all optional :
+ *  --labels N      : number of labels (default 50).
+ *  --views K       : slice views, there is always one 3D view (default 3).
+ *  --iterations I  : control point moves and slice steps (default 5).
+ *  --output file, --max-mean-ms T : see ExtraMarkupsBenchmarkFixture.
+ */
+
+// Label includes
+#include "vtkMRMLMarkupsLabelNode.h"
+#include "vtkSlicerLabelLogic.h"
+#include "vtkSlicerLabelWidget.h"
+
+// Extension testing includes
+#include "ExtraMarkupsBenchmarkFixture.h"
+
+// Markups includes
+#include <vtkMRMLMarkupsDisplayNode.h>
+#include <vtkSlicerMarkupsWidgetRepresentation.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct LabelView
+{
+  vtkSmartPointer<vtkSlicerLabelWidget> Widget;
+  vtkMRMLMarkupsLabelNode * LabelNode { nullptr };
+  vtkMRMLSliceNode * SliceNode { nullptr }; // nullptr in the 3D view
+};
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerLabelBenchmark(int argc, char * argv[])
+{
+  ExtraMarkupsBenchmarkFixture fixture("Label",
+    { { "labels", 50 }, { "views", 3 }, { "iterations", 5 } });
+  if (!fixture.ParseArguments(argc, argv))
+  {
+    return EXIT_FAILURE;
+  }
+  const int numberOfLabels = fixture.GetParameter("labels");
+  const int numberOfSliceViews = fixture.GetParameter("views");
+  const int numberOfIterations = fixture.GetParameter("iterations");
+  vtkMRMLScene * scene = fixture.Scene;
+  ExtraMarkupsBenchmarkResults& results = fixture.Results;
+
+  vtkNew<vtkSlicerLabelLogic> labelLogic;
+  fixture.SetUpModuleLogic(labelLogic);
+
+  // Labels on a grid, the text away from the tip.
+  std::vector<vtkMRMLMarkupsLabelNode*> labelNodes;
+  for (int i = 0; i < numberOfLabels; i++)
+  {
+    vtkMRMLMarkupsLabelNode * labelNode = vtkMRMLMarkupsLabelNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLMarkupsLabelNode"));
+    labelNode->CreateDefaultDisplayNodes();
+    labelNode->SetLabel(QString("Label %1").arg(i));
+    const double tip[3] = { 20.0 * (i % 10), 20.0 * (i / 10), 0.0 };
+    const double text[3] = { tip[0] + 10.0, tip[1] + 10.0, tip[2] };
+    labelNode->AddControlPointWorld(vtkVector3d(tip[0], tip[1], tip[2]));
+    labelNode->AddControlPointWorld(vtkVector3d(text[0], text[1], text[2]));
+    labelNodes.push_back(labelNode);
+  }
+
+  fixture.CreateViews(numberOfSliceViews);
+  const std::vector<vtkMRMLSliceNode*>& sliceNodes = fixture.SliceNodes;
+
+  // One widget per label and view, without displayable managers : representations are updated here.
+  std::vector<LabelView> labelViews;
+  for (vtkMRMLMarkupsLabelNode * labelNode : labelNodes)
+  {
+    vtkMRMLMarkupsDisplayNode * displayNode = vtkMRMLMarkupsDisplayNode::SafeDownCast(labelNode->GetDisplayNode());
+    for (int j = -1; j < numberOfSliceViews; j++)
+    {
+      LabelView labelView;
+      labelView.Widget = vtkSmartPointer<vtkSlicerLabelWidget>::New();
+      labelView.LabelNode = labelNode;
+      labelView.SliceNode = (j >= 0) ? sliceNodes[j] : nullptr;
+      labelView.Widget->CreateDefaultRepresentation(displayNode, fixture.GetViewNode(j), fixture.GetRenderer(j));
+      labelViews.push_back(labelView);
+    }
+  }
+
+  vtkNew<vtkTimerLog> timer;
+  // Tip moves, back and forth.
+  for (int iteration = 0; iteration < numberOfIterations; iteration++)
+  {
+    for (vtkMRMLMarkupsLabelNode * labelNode : labelNodes)
+    {
+      double position[3] = { 0.0 };
+      labelNode->GetNthControlPointPositionWorld(0, position);
+      position[0] += (iteration % 2 == 0) ? 0.1 : -0.1;
+      labelNode->SetNthControlPointPositionWorld(0, position);
+    }
+    for (const LabelView& labelView : labelViews)
+    {
+      vtkSlicerMarkupsWidgetRepresentation * representation =
+        vtkSlicerMarkupsWidgetRepresentation::SafeDownCast(labelView.Widget->GetRepresentation());
+      timer->StartTimer();
+      representation->UpdateFromMRML(labelView.LabelNode, vtkMRMLMarkupsNode::PointModifiedEvent);
+      timer->StopTimer();
+      results.Add(labelView.SliceNode ? "UpdateFromMRML2D" : "UpdateFromMRML3D", "Label", timer->GetElapsedTime());
+    }
+  }
+
+  // Slice scrolling : all 2D representations of a slice view are updated at each step.
+  for (vtkMRMLSliceNode * sliceNode : sliceNodes)
+  {
+    const double initialOffset = sliceNode->GetSliceOffset();
+    for (int iteration = 0; iteration < numberOfIterations; iteration++)
+    {
+      sliceNode->SetSliceOffset(initialOffset + iteration);
+      for (const LabelView& labelView : labelViews)
+      {
+        if (labelView.SliceNode != sliceNode)
+        {
+          continue;
+        }
+        vtkSlicerMarkupsWidgetRepresentation * representation =
+          vtkSlicerMarkupsWidgetRepresentation::SafeDownCast(labelView.Widget->GetRepresentation());
+        timer->StartTimer();
+        representation->UpdateFromMRML(sliceNode, vtkCommand::ModifiedEvent);
+        timer->StopTimer();
+        results.Add("SliceScroll", "Label", timer->GetElapsedTime());
+      }
+    }
+    sliceNode->SetSliceOffset(initialOffset);
+  }
+
+  return fixture.WriteResults();
+}
@@ -19,12 +19,14 @@
 ==============================================================================*/
 
 #include "vtkSlicerLabelRepresentation2D.h"
+#include "vtkSlicerLabelRepresentationHelper.h"
 
 #include <vtkActor2D.h>
 #include <vtkGlyphSource2D.h>
 #include <vtkPolyDataMapper2D.h>
 #include <vtkProperty2D.h>
 #include <vtkPlane.h>
+#include <vtkTextActor.h>
 
 #include <cmath>
 
@@ -126,12 +128,12 @@ void vtkSlicerLabelRepresentation2D::UpdateFromMRML(vtkMRMLNode* caller, unsigne
     this->TextActor->SetVisibility(false);
   }
   
-  this->TextActor->SetInput(labelNode->GetLabel().toStdString().c_str());
   this->TextActor->SetPosition(p1[0], p1[1]);
   
   int controlPointType = this->GetAllControlPointsSelected() ? Selected : Unselected;
   this->LineActor->SetProperty(this->GetControlPointsPipeline(controlPointType)->Property);
-  this->TextActor->SetTextProperty(this->GetControlPointsPipeline(controlPointType)->TextProperty);
+  vtkSlicerLabelRepresentationHelper::UpdateTextActor(this->TextActor, labelNode,
+    this->GetControlPointsPipeline(controlPointType)->TextProperty);
   
   vtkMarkupsGlyphSource2D * glyphSource2D = this->GetControlPointsPipeline(controlPointType)->GlyphSource2D;
   /* Unfortunately, there is apparently no selective control of the glyph to use on each control point.
@@ -19,6 +19,7 @@
 ==============================================================================*/
 
 #include "vtkSlicerLabelRepresentation3D.h"
+#include "vtkSlicerLabelRepresentationHelper.h"
 
 #include "vtkMRMLMarkupsLabelNode.h"
 
@@ -34,43 +35,231 @@
 #include <vtkGlyph3DMapper.h>
 #include <vtkRenderer.h>
 #include <vtkCamera.h>
+#include <vtkCallbackCommand.h>
+#include <vtkMath.h>
 //#include <vtkMRMLScene.h>
 
+// MRML includes
+#include <vtkMRMLAbstractViewNode.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// One per view : all label representations of a view observe its camera through it.
+// If the view node attribute MarkupsLabel.Declutter is "true", the text of a label
+// is hidden if its anchor falls in a screen cell already used by another label,
+// selected labels first, then in creation order. MarkupsLabel.DeclutterCellSize
+// is the cell size in pixels.
+class vtkSlicerLabelCameraDispatcher
+{
+public:
+  static void Register(vtkRenderer * renderer, vtkSlicerLabelRepresentation3D * representation)
+  {
+    std::unique_ptr<vtkSlicerLabelCameraDispatcher>& dispatcher = GetDispatchers()[renderer];
+    if (!dispatcher)
+    {
+      dispatcher.reset(new vtkSlicerLabelCameraDispatcher(renderer));
+    }
+    dispatcher->Representations.push_back(representation);
+  }
+  static void Unregister(vtkRenderer * renderer, vtkSlicerLabelRepresentation3D * representation)
+  {
+    auto found = GetDispatchers().find(renderer);
+    if (found == GetDispatchers().end())
+    {
+      return;
+    }
+    std::vector<vtkSlicerLabelRepresentation3D*>& representations = found->second->Representations;
+    representations.erase(std::remove(representations.begin(), representations.end(), representation),
+                          representations.end());
+    if (found->second->Representations.empty())
+    {
+      GetDispatchers().erase(found);
+    }
+  }
+  ~vtkSlicerLabelCameraDispatcher()
+  {
+    if (this->Renderer)
+    {
+      this->Renderer->RemoveObserver(this->RenderCallback);
+    }
+  }
+
+private:
+  vtkSlicerLabelCameraDispatcher(vtkRenderer * renderer)
+  {
+    this->Renderer = renderer;
+    this->RenderCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+    this->RenderCallback->SetClientData( reinterpret_cast<void *>(this) );
+    this->RenderCallback->SetCallback( vtkSlicerLabelCameraDispatcher::OnRendererEvent );
+    renderer->AddObserver(vtkCommand::StartEvent, this->RenderCallback);
+    renderer->AddObserver(vtkCommand::DeleteEvent, this->RenderCallback);
+  }
+  static std::map<vtkRenderer*, std::unique_ptr<vtkSlicerLabelCameraDispatcher>>& GetDispatchers()
+  {
+    static std::map<vtkRenderer*, std::unique_ptr<vtkSlicerLabelCameraDispatcher>> dispatchers;
+    return dispatchers;
+  }
+  // Start of a frame : all camera modifications since the previous frame at once.
+  static void OnRendererEvent(vtkObject * caller, unsigned long event, void * clientData, void * callData)
+  {
+    vtkSlicerLabelCameraDispatcher * self = reinterpret_cast<vtkSlicerLabelCameraDispatcher*>(clientData);
+    if (event == vtkCommand::DeleteEvent)
+    {
+      GetDispatchers().erase(vtkRenderer::SafeDownCast(caller));
+      return;
+    }
+    vtkCamera * camera = self->Renderer ? self->Renderer->GetActiveCamera() : nullptr;
+    if (!camera)
+    {
+      return;
+    }
+    if (camera != self->Camera || camera->GetMTime() != self->CameraTime)
+    {
+      self->Camera = camera;
+      self->CameraTime = camera->GetMTime();
+      for (vtkSlicerLabelRepresentation3D * representation : self->Representations)
+      {
+        representation->HideControlPointGlyphs();
+      }
+    }
+    self->Declutter(camera);
+  }
+  // One pass over the labels, the cells are hashed.
+  void Declutter(vtkCamera * camera)
+  {
+    vtkMRMLAbstractViewNode * viewNode = this->Representations.empty()
+                                         ? nullptr : this->Representations.front()->GetViewNode();
+    const char * declutter = viewNode ? viewNode->GetAttribute("MarkupsLabel.Declutter") : nullptr;
+    if (!declutter || std::strcmp(declutter, "true") != 0)
+    {
+      if (this->Decluttering)
+      {
+        for (vtkSlicerLabelRepresentation3D * representation : this->Representations)
+        {
+          representation->SetTextDecluttered(false);
+        }
+        this->Decluttering = false;
+      }
+      return;
+    }
+    this->Decluttering = true;
+    
+    double cellSize = 60.0;
+    const char * cellSizeAttribute = viewNode->GetAttribute("MarkupsLabel.DeclutterCellSize");
+    if (cellSizeAttribute && std::atof(cellSizeAttribute) >= 1.0)
+    {
+      cellSize = std::atof(cellSizeAttribute);
+    }
+    const int * size = this->Renderer->GetSize();
+    vtkMatrix4x4 * worldToView = camera->GetCompositeProjectionTransformMatrix(
+      this->Renderer->GetTiledAspectRatio(), -1.0, 1.0);
+    
+    this->OccupiedCells.clear();
+    this->OccupiedCells.reserve(2 * this->Representations.size());
+    for (bool selected : { true, false })
+    {
+      for (vtkSlicerLabelRepresentation3D * representation : this->Representations)
+      {
+        if (representation->GetAllControlPointsSelected() != selected)
+        {
+          continue;
+        }
+        if (!representation->TextVisible || !representation->GetVisibility())
+        {
+          representation->SetTextDecluttered(false);
+          continue;
+        }
+        double anchor[4] = { representation->TextActorPositionWorld[0],
+                             representation->TextActorPositionWorld[1],
+                             representation->TextActorPositionWorld[2], 1.0 };
+        worldToView->MultiplyPoint(anchor, anchor);
+        if (anchor[3] <= 0.0)
+        {
+          // Behind the camera.
+          representation->SetTextDecluttered(false);
+          continue;
+        }
+        const double x = (anchor[0] / anchor[3] + 1.0) * 0.5 * size[0];
+        const double y = (anchor[1] / anchor[3] + 1.0) * 0.5 * size[1];
+        if (x < 0.0 || x >= size[0] || y < 0.0 || y >= size[1])
+        {
+          // Outside the viewport, it does not hide anything.
+          representation->SetTextDecluttered(false);
+          continue;
+        }
+        const unsigned long long cell = ((unsigned long long) (unsigned int) (x / cellSize) << 32)
+                                        | (unsigned int) (y / cellSize);
+        representation->SetTextDecluttered(!this->OccupiedCells.insert(cell).second);
+      }
+    }
+  }
+  
+  vtkWeakPointer<vtkRenderer> Renderer;
+  vtkWeakPointer<vtkCamera> Camera;
+  vtkMTimeType CameraTime { 0 };
+  vtkSmartPointer<vtkCallbackCommand> RenderCallback;
+  std::vector<vtkSlicerLabelRepresentation3D*> Representations; // In creation order
+  bool Decluttering { false };
+  std::unordered_set<unsigned long long> OccupiedCells;
+};
+
 //------------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerLabelRepresentation3D);
 
 //------------------------------------------------------------------------------
 vtkSlicerLabelRepresentation3D::vtkSlicerLabelRepresentation3D()
 {
+  // From p1 at the origin to p2 at (1, 0, 0), scaled along x by the line length.
   this->LineSource = vtkSmartPointer<vtkLineSource>::New();
+  this->LineSource->SetPoint1(0.0, 0.0, 0.0);
+  this->LineSource->SetPoint2(1.0, 0.0, 0.0);
+  this->LineSource->Update();
+  // Centered on p2, the tip pointing away from p1.
   this->ConeSource = vtkSmartPointer<vtkConeSource>::New();
-  this->AppendedArrow = vtkSmartPointer<vtkAppendPolyData>::New();
+  this->ConeSource->SetCenter(0.0, 0.0, 0.0);
+  this->ConeSource->SetDirection(1.0, 0.0, 0.0);
+  this->ConeSource->SetRadius(1.0);
+  this->ConeSource->SetHeight(2.5);
+  this->ConeSource->SetResolution(45);
+  this->ConeSource->Update();
   
-  this->AppendedArrow->AddInputConnection(this->LineSource->GetOutputPort());
-  this->AppendedArrow->AddInputConnection(this->ConeSource->GetOutputPort());
+  this->ArrowMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  this->ArrowHeadMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   
   this->ArrowMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-  this->ArrowMapper->SetInputConnection(this->AppendedArrow->GetOutputPort());
+  this->ArrowMapper->SetInputConnection(this->LineSource->GetOutputPort());
   this->ArrowMapper->SetScalarVisibility(true);
   
   this->ArrowActor = vtkSmartPointer<vtkActor>::New();
   this->ArrowActor->SetMapper(this->ArrowMapper);
+  this->ArrowActor->SetUserMatrix(this->ArrowMatrix);
   this->ArrowActor->SetProperty(this->GetControlPointsPipeline(Unselected)->Property);
   
+  this->ArrowHeadMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+  this->ArrowHeadMapper->SetInputConnection(this->ConeSource->GetOutputPort());
+  this->ArrowHeadMapper->SetScalarVisibility(true);
+  
+  this->ArrowHeadActor = vtkSmartPointer<vtkActor>::New();
+  this->ArrowHeadActor->SetMapper(this->ArrowHeadMapper);
+  this->ArrowHeadActor->SetUserMatrix(this->ArrowHeadMatrix);
+  this->ArrowHeadActor->SetProperty(this->GetControlPointsPipeline(Unselected)->Property);
+  
   this->TextActor->SetTextProperty(this->GetControlPointsPipeline(Unselected)->TextProperty);
-  this->ConeSource->SetAngle(30.0);
-
-  this->CameraModifiedCallbackCommand = vtkSmartPointer<vtkCallbackCommand>::New();
-  this->CameraModifiedCallbackCommand->SetClientData( reinterpret_cast<void *>(this) );
-  this->CameraModifiedCallbackCommand->SetCallback( vtkSlicerLabelRepresentation3D::OnCameraModified );
 }
 
 //------------------------------------------------------------------------------
 vtkSlicerLabelRepresentation3D::~vtkSlicerLabelRepresentation3D()
 {
-  if (this->CameraIsBeingObserved)
+  if (this->DispatcherRenderer)
   {
-    this->GetRenderer()->GetActiveCamera()->RemoveObserver(this->CameraModifiedCallbackCommand);
+    vtkSlicerLabelCameraDispatcher::Unregister(this->DispatcherRenderer, this);
     //this->SetCameraObservationStatus(false);
   }
 }
@@ -96,6 +285,7 @@ void vtkSlicerLabelRepresentation3D::GetActors(vtkPropCollection* pc)
   this->Superclass::GetActors(pc);
 
   this->ArrowActor->GetActors(pc);
+  this->ArrowHeadActor->GetActors(pc);
   this->TextActor->GetActors(pc);
 }
 
@@ -105,6 +295,7 @@ void vtkSlicerLabelRepresentation3D::ReleaseGraphicsResources(vtkWindow* win)
   this->Superclass::ReleaseGraphicsResources(win);
 
   this->ArrowActor->ReleaseGraphicsResources(win);
+  this->ArrowHeadActor->ReleaseGraphicsResources(win);
   this->TextActor->ReleaseGraphicsResources(win);
 }
 
@@ -117,6 +308,10 @@ int vtkSlicerLabelRepresentation3D::RenderOverlay(vtkViewport* viewport)
     {
     count += this->ArrowActor->RenderOverlay(viewport);
     }
+  if (this->ArrowHeadActor->GetVisibility())
+    {
+    count += this->ArrowHeadActor->RenderOverlay(viewport);
+    }
   if (this->TextActor->GetVisibility())
     {
       count += this->TextActor->RenderOverlay(viewport);
@@ -133,6 +328,10 @@ int vtkSlicerLabelRepresentation3D::RenderOpaqueGeometry(vtkViewport* viewport)
     {
     count += this->ArrowActor->RenderOpaqueGeometry(viewport);
     }
+  if (this->ArrowHeadActor->GetVisibility())
+    {
+    count += this->ArrowHeadActor->RenderOpaqueGeometry(viewport);
+    }
   if (this->TextActor->GetVisibility())
     {
       count += this->TextActor->RenderOpaqueGeometry(viewport);
@@ -151,6 +350,11 @@ int vtkSlicerLabelRepresentation3D::RenderTranslucentPolygonalGeometry(vtkViewpo
     this->ArrowActor->SetPropertyKeys(this->GetPropertyKeys());
     count += this->ArrowActor->RenderTranslucentPolygonalGeometry(viewport);
     }
+  if (this->ArrowHeadActor->GetVisibility())
+    {
+    this->ArrowHeadActor->SetPropertyKeys(this->GetPropertyKeys());
+    count += this->ArrowHeadActor->RenderTranslucentPolygonalGeometry(viewport);
+    }
   if (this->TextActor->GetVisibility())
     {
       this->TextActor->SetPropertyKeys(this->GetPropertyKeys());
@@ -173,6 +377,11 @@ vtkTypeBool vtkSlicerLabelRepresentation3D::HasTranslucentPolygonalGeometry()
     {
     return true;
     }
+  if (this->ArrowHeadActor->GetVisibility() &&
+      this->ArrowHeadActor->HasTranslucentPolygonalGeometry())
+    {
+    return true;
+    }
   if (this->TextActor->GetVisibility() &&
       this->TextActor->HasTranslucentPolygonalGeometry())
     {
@@ -197,57 +406,86 @@ void vtkSlicerLabelRepresentation3D::UpdateFromMRML(vtkMRMLNode* caller,
     return;
   }
   vtkMRMLMarkupsLabelNode * labelNode = vtkMRMLMarkupsLabelNode::SafeDownCast(markupsNode);
-  if (!this->CameraIsBeingObserved)
+  if (this->DispatcherRenderer != this->GetRenderer())
   {
-    this->GetRenderer()->GetActiveCamera()->AddObserver(vtkCommand::ModifiedEvent, this->CameraModifiedCallbackCommand);
-    this->CameraIsBeingObserved = true; // remove if using vtkMRMLCameraNode
+    if (this->DispatcherRenderer)
+    {
+      vtkSlicerLabelCameraDispatcher::Unregister(this->DispatcherRenderer, this);
+    }
+    this->DispatcherRenderer = this->GetRenderer();
+    if (this->DispatcherRenderer)
+    {
+      vtkSlicerLabelCameraDispatcher::Register(this->DispatcherRenderer, this);
+    }
     //this->SetCameraObservationStatus(true);
   }
   double p1[3] = { 0.0 };
   double p2[3] = { 0.0 };
   markupsNode->GetNthControlPointPositionWorld(0, p1);
   markupsNode->GetNthControlPointPositionWorld(1, p2);
-  double direction[3] = { 0.0 };
-  vtkMath::Subtract(p2, p1, direction);
-  
-  this->LineSource->SetPoint1(p1);
-  this->LineSource->SetPoint2(p2);
-  this->LineSource->Update();
-  this->ConeSource->SetCenter(p2);
-  this->ConeSource->SetRadius(1.0);
-  this->ConeSource->SetHeight(2.5);
-  this->ConeSource->SetResolution(45);
-  this->ConeSource->SetDirection(direction);
-  this->ConeSource->Update();
-  
-  // p1, the center (tip) of the cone, has always id 0.
-  vtkIdType closestIdToP2 = this->ConeSource->GetOutput()->FindPoint(p1);
-  // If the tip is closest, it's inversely oriented.
-  if (closestIdToP2 == 0)
-  {
-    // Invert direction.
-    vtkMath::Subtract(p1, p2, direction);
-    this->ConeSource->SetDirection(direction);
-    this->ConeSource->Update();
-  }
-  
-  this->AppendedArrow->Update();
-  this->TextActor->SetInput(labelNode->GetLabel().toStdString().c_str());
+  const bool arrowDefined = this->UpdateArrowMatrices(p1, p2);
   this->TextActorPositionWorld[0] = p1[0];
   this->TextActorPositionWorld[1] = p1[1];
   this->TextActorPositionWorld[2] = p1[2];
   
-  this->ArrowActor->SetVisibility(markupsNode->GetNumberOfDefinedControlPoints(true) == 2);
-  this->TextActor->SetVisibility(markupsNode->GetNumberOfDefinedControlPoints(true) == 2);
+  const bool visible = (markupsNode->GetNumberOfDefinedControlPoints(true) == 2);
+  this->ArrowActor->SetVisibility(visible && arrowDefined);
+  this->ArrowHeadActor->SetVisibility(visible && arrowDefined);
+  this->TextVisible = visible;
+  this->TextActor->SetVisibility(visible && !this->TextDecluttered);
   
   int controlPointType = this->GetAllControlPointsSelected() ? Selected : Unselected;
   this->ArrowActor->SetProperty(this->GetControlPointsPipeline(controlPointType)->Property);
-  this->TextActor->SetTextProperty(this->GetControlPointsPipeline(controlPointType)->TextProperty);
+  this->ArrowHeadActor->SetProperty(this->GetControlPointsPipeline(controlPointType)->Property);
+  vtkSlicerLabelRepresentationHelper::UpdateTextActor(this->TextActor, labelNode,
+    this->GetControlPointsPipeline(controlPointType)->TextProperty);
 
-  //Hide a control point by decreasing its size.
-  this->GetControlPointsPipeline(controlPointType)->GlyphMapper->SetScaleFactor(0.01);
+  this->HideControlPointGlyphs();
   // Shrink the control points on markups creation.
-  this->UpdateViewScaleFactor();
+  const int numberOfDefinedControlPoints = markupsNode->GetNumberOfDefinedControlPoints(true);
+  if (numberOfDefinedControlPoints != this->LastNumberOfDefinedControlPoints)
+  {
+    this->LastNumberOfDefinedControlPoints = numberOfDefinedControlPoints;
+    this->UpdateViewScaleFactor();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerLabelRepresentation3D::UpdateArrowMatrices(const double * p1, const double * p2)
+{
+  // Frame of the glyphs : x along p1 -> p2.
+  double axisX[3] = { p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2] };
+  const double length = vtkMath::Normalize(axisX);
+  if (length == 0.0)
+  {
+    return false;
+  }
+  double axisY[3] = { 0.0 };
+  double axisZ[3] = { 0.0 };
+  vtkMath::Perpendiculars(axisX, axisY, axisZ, 0.0);
+  for (int i = 0; i < 3; i++)
+  {
+    this->ArrowMatrix->SetElement(i, 0, axisX[i] * length);
+    this->ArrowMatrix->SetElement(i, 1, axisY[i]);
+    this->ArrowMatrix->SetElement(i, 2, axisZ[i]);
+    this->ArrowMatrix->SetElement(i, 3, p1[i]);
+    this->ArrowHeadMatrix->SetElement(i, 0, axisX[i]);
+    this->ArrowHeadMatrix->SetElement(i, 1, axisY[i]);
+    this->ArrowHeadMatrix->SetElement(i, 2, axisZ[i]);
+    this->ArrowHeadMatrix->SetElement(i, 3, p2[i]);
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerLabelRepresentation3D::SetTextDecluttered(bool decluttered)
+{
+  this->TextDecluttered = decluttered;
+  const bool visible = this->TextVisible && !decluttered;
+  if (this->TextActor->GetVisibility() != visible)
+  {
+    this->TextActor->SetVisibility(visible);
+  }
 }
 
 //---------------------------------------------------------------------------
@@ -260,23 +498,23 @@ void vtkSlicerLabelRepresentation3D::UpdateFromMRML(vtkMRMLNode* caller,
  * - vtkMRMLCameraNode observed via vtkMRMLCameraNode::CameraInteractionEvent
  * Got better, but insufficient.
  */
-void vtkSlicerLabelRepresentation3D::OnCameraModified(vtkObject *caller,
-                 unsigned long event, void *clientData, void *callData)
+void vtkSlicerLabelRepresentation3D::HideControlPointGlyphs()
 {
-  vtkSlicerLabelRepresentation3D * client = reinterpret_cast<vtkSlicerLabelRepresentation3D*>(clientData);
-  if (!client)
+  // Hide a control point by decreasing its size.
+  const double hiddenScaleFactor = 0.01;
+  int controlPointType = this->GetAllControlPointsSelected() ? Selected : Unselected;
+  vtkGlyph3DMapper * glyphMapper = this->GetControlPointsPipeline(controlPointType)->GlyphMapper;
+  if (glyphMapper->GetScaleFactor() != hiddenScaleFactor)
   {
-    return;
+    glyphMapper->SetScaleFactor(hiddenScaleFactor);
   }
-  int controlPointType = client->GetAllControlPointsSelected() ? Selected : Unselected;
-  client->GetControlPointsPipeline(controlPointType)->GlyphMapper->SetScaleFactor(0.01);
 }
 
 //----------------------------------------------------------------------
 double * vtkSlicerLabelRepresentation3D::GetBounds()
 {
   vtkBoundingBox boundingBox;
-  const std::vector<vtkProp*> actors({ this->ArrowActor });
+  const std::vector<vtkProp*> actors({ this->ArrowActor, this->ArrowHeadActor });
   this->AddActorsBounds(boundingBox, actors, Superclass::GetBounds());
   boundingBox.GetBounds(this->Bounds);
   return this->Bounds;
@@ -30,9 +30,11 @@
 #include <vtkWeakPointer.h>
 #include <vtkConeSource.h>
 #include <vtkLineSource.h>
-#include <vtkCallbackCommand.h>
+#include <vtkMatrix4x4.h>
 //#include <vtkMRMLCameraNode.h>
 
+class vtkRenderer;
+
 //------------------------------------------------------------------------------
 /**
  * @class   vtkSlicerLabelRepresentation3D
@@ -69,16 +71,26 @@ protected:
   vtkSlicerLabelRepresentation3D();
   ~vtkSlicerLabelRepresentation3D() override;
 
+  // Unit glyphs along +x, built once and placed from p1 and p2 by the user matrices.
   vtkSmartPointer<vtkLineSource> LineSource;
   vtkSmartPointer<vtkConeSource> ConeSource;
-  vtkSmartPointer<vtkAppendPolyData> AppendedArrow;
   vtkSmartPointer<vtkPolyDataMapper> ArrowMapper;
-  vtkSmartPointer<vtkActor> ArrowActor;
+  vtkSmartPointer<vtkActor> ArrowActor; // Line
+  vtkSmartPointer<vtkPolyDataMapper> ArrowHeadMapper;
+  vtkSmartPointer<vtkActor> ArrowHeadActor; // Cone
+  vtkSmartPointer<vtkMatrix4x4> ArrowMatrix;
+  vtkSmartPointer<vtkMatrix4x4> ArrowHeadMatrix;
+  bool UpdateArrowMatrices(const double * p1, const double * p2);
   
-  vtkSmartPointer<vtkCallbackCommand> CameraModifiedCallbackCommand;
-  static void OnCameraModified(vtkObject *caller,
-                               unsigned long event, void *clientData, void *callData);
-  bool CameraIsBeingObserved = false;
+  // Camera changes are dispatched once per rendered frame, by one observer per view.
+  friend class vtkSlicerLabelCameraDispatcher;
+  void HideControlPointGlyphs();
+  vtkWeakPointer<vtkRenderer> DispatcherRenderer;
+  int LastNumberOfDefinedControlPoints { -1 };
+  // The text is hidden by the dispatcher if it overlaps a label of higher priority.
+  void SetTextDecluttered(bool decluttered);
+  bool TextVisible { false };
+  bool TextDecluttered { false };
   //vtkWeakPointer<vtkMRMLCameraNode> MRMLCamera;
   //bool SetCameraObservationStatus(bool observe);
   
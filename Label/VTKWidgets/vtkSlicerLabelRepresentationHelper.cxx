@@ -0,0 +1,52 @@
+/*==============================================================================
+
+ Distributed under the OSI-approved BSD 3-Clause License.
+
+  Copyright (c) Oslo University Hospital. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+  * Neither the name of Oslo University Hospital nor the names
+    of Contributors may be used to endorse or promote products derived
+
+#include "vtkSlicerLabelRepresentationHelper.h"
+
+#include <vtkTextActor.h>
+
+#include <cstring>
+
+#include "vtkMRMLMarkupsLabelNode.h"
+
+//-----------------------------------------------------------------------------
+void vtkSlicerLabelRepresentationHelper::UpdateTextActor(vtkTextActor * textActor,
+                                                         vtkMRMLMarkupsLabelNode * labelNode,
+                                                         vtkTextProperty * textProperty)
+{
+  if (!textActor)
+  {
+    return;
+  }
+  if (textActor->GetTextProperty() != textProperty)
+  {
+    textActor->SetTextProperty(textProperty);
+  }
+  if (!labelNode)
+  {
+    return;
+  }
+  const char * input = textActor->GetInput();
+  if (input && std::strcmp(input, labelNode->GetLabelText()) == 0)
+  {
+    return;
+  }
+  textActor->SetInput(labelNode->GetLabelText());
+}
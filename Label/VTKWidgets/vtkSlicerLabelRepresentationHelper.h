@@ -0,0 +1,41 @@
+/*==============================================================================
+
+ Distributed under the OSI-approved BSD 3-Clause License.
+
+  Copyright (c) Oslo University Hospital. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+  * Neither the name of Oslo University Hospital nor the names
+    of Contributors may be used to endorse or promote products derived
+
+#ifndef __vtkslicerlabelrepresentationhelper_h_
+#define __vtkslicerlabelrepresentationhelper_h_
+
+#include "vtkSlicerLabelModuleVTKWidgetsExport.h"
+
+class vtkMRMLMarkupsLabelNode;
+class vtkTextActor;
+class vtkTextProperty;
+
+/**
+ * Shared by the 2D and 3D label representations.
+ */
+class VTK_SLICER_LABEL_MODULE_VTKWIDGETS_EXPORT vtkSlicerLabelRepresentationHelper
+{
+public:
+  /// The text is rasterized again only if it or its property change.
+  static void UpdateTextActor(vtkTextActor * textActor, vtkMRMLMarkupsLabelNode * labelNode,
+                              vtkTextProperty * textProperty);
+};
+
+#endif
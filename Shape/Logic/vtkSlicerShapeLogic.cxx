@@ -21,7 +21,10 @@
 #include "vtkSlicerShapeLogic.h"
 
 // Shape MRML includes
+#include "vtkMRMLMarkupsShapeDisplayNode.h"
 #include "vtkMRMLMarkupsShapeNode.h"
+#include "vtkMRMLMeasurementShape.h"
+#include "vtkShapeTimingCounters.h"
 
 // Shape VTKWidgets includes
 #include "vtkSlicerShapeWidget.h"
@@ -29,6 +32,9 @@
 // MRML includes
 #include <vtkMRMLScene.h>
 
+// Slicer includes
+#include <vtkSlicerApplicationLogic.h>
+
 // Markups logic includes
 #include <vtkSlicerMarkupsLogic.h>
 
@@ -36,7 +42,16 @@
 #include <vtkMRMLMarkupsDisplayNode.h>
 
 // VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkIntArray.h>
+#include <vtkMath.h>
 #include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkStringArray.h>
+#include <vtkTable.h>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerShapeLogic);
@@ -44,10 +59,35 @@ vtkStandardNewMacro(vtkSlicerShapeLogic);
 //---------------------------------------------------------------------------
 vtkSlicerShapeLogic::vtkSlicerShapeLogic()
 {
+  this->MeasurementsReadyProxy = vtkSmartPointer<vtkObject>::New();
+  this->MeasurementsReadyCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->MeasurementsReadyCallback->SetClientData( reinterpret_cast<void *>(this) );
+  this->MeasurementsReadyCallback->SetCallback( vtkSlicerShapeLogic::OnMeasurementsReadyProxyModified );
+  this->MeasurementsReadyProxy->AddObserver(vtkCommand::ModifiedEvent, this->MeasurementsReadyCallback);
 }
 
 //---------------------------------------------------------------------------
-vtkSlicerShapeLogic::~vtkSlicerShapeLogic() = default;
+vtkSlicerShapeLogic::~vtkSlicerShapeLogic()
+{
+  // No worker may call back into this logic, or run once the module is unloaded.
+  vtkMRMLScene * scene = this->GetMRMLScene();
+  if (scene)
+  {
+    std::vector<vtkMRMLNode*> shapeNodes;
+    scene->GetNodesByClass("vtkMRMLMarkupsShapeNode", shapeNodes);
+    for (vtkMRMLNode * node : shapeNodes)
+    {
+      vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(node);
+      if (shapeNode)
+      {
+        shapeNode->SetMeasurementsReadyCallback(nullptr, nullptr);
+        shapeNode->CancelAsynchronousMeasurements();
+      }
+    }
+  }
+  // A pending request may still modify the proxy.
+  this->MeasurementsReadyProxy->RemoveObserver(this->MeasurementsReadyCallback);
+}
 
 //---------------------------------------------------------------------------
 void vtkSlicerShapeLogic::PrintSelf(ostream& os, vtkIndent indent)
@@ -55,6 +95,64 @@ void vtkSlicerShapeLogic::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
 }
 
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::SetMRMLSceneInternal(vtkMRMLScene * newScene)
+{
+  // Workers of the nodes of the previous scene no longer call back into this logic.
+  this->SetMeasurementsReadyCallbacks(this->GetMRMLScene(), false);
+  this->Superclass::SetMRMLSceneInternal(newScene);
+  this->SetMeasurementsReadyCallbacks(newScene, true);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::OnMRMLSceneNodeAdded(vtkMRMLNode * node)
+{
+  this->Superclass::OnMRMLSceneNodeAdded(node);
+  vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(node);
+  if (shapeNode)
+  {
+    shapeNode->SetMeasurementsReadyCallback(vtkSlicerShapeLogic::OnMeasurementsReady, this);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode * node)
+{
+  this->Superclass::OnMRMLSceneNodeRemoved(node);
+  vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(node);
+  if (shapeNode)
+  {
+    shapeNode->SetMeasurementsReadyCallback(nullptr, nullptr);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::SetMeasurementsReadyCallbacks(vtkMRMLScene * scene, bool observe)
+{
+  if (!scene)
+  {
+    return;
+  }
+  std::vector<vtkMRMLNode*> shapeNodes;
+  scene->GetNodesByClass("vtkMRMLMarkupsShapeNode", shapeNodes);
+  for (vtkMRMLNode * node : shapeNodes)
+  {
+    vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(node);
+    if (!shapeNode)
+    {
+      continue;
+    }
+    if (observe)
+    {
+      shapeNode->SetMeasurementsReadyCallback(vtkSlicerShapeLogic::OnMeasurementsReady, this);
+    }
+    else
+    {
+      shapeNode->SetMeasurementsReadyCallback(nullptr, nullptr);
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlicerShapeLogic::RegisterNodes()
 {
@@ -72,7 +170,286 @@ void vtkSlicerShapeLogic::RegisterNodes()
     return;
     }
 
+  scene->RegisterNodeClass(vtkSmartPointer<vtkMRMLMarkupsShapeDisplayNode>::New());
+  
   vtkNew<vtkMRMLMarkupsShapeNode> markupsShapeNode;
   vtkNew<vtkSlicerShapeWidget> ShapeWidget;
   markupsLogic->RegisterMarkupsNode(markupsShapeNode, ShapeWidget);
 }
+
+//---------------------------------------------------------------------------
+int vtkSlicerShapeLogic::CreateShapes(vtkDataArray * centers, vtkDataArray * radii, vtkDataArray * normals,
+                                      vtkDataArray * shapeTypes, vtkCollection * createdNodes)
+{
+  vtkMRMLScene *scene = this->GetMRMLScene();
+  if (!scene)
+  {
+    vtkErrorMacro("CreateShapes failed: invalid scene");
+    return 0;
+  }
+  if (!centers || !radii || !shapeTypes
+    || centers->GetNumberOfComponents() != 3
+    || radii->GetNumberOfComponents() < 1 || radii->GetNumberOfComponents() > 2
+    || (normals && normals->GetNumberOfComponents() != 3))
+  {
+    vtkErrorMacro("CreateShapes failed: invalid input arrays");
+    return 0;
+  }
+  const vtkIdType numberOfShapes = centers->GetNumberOfTuples();
+  if (radii->GetNumberOfTuples() != numberOfShapes
+    || shapeTypes->GetNumberOfTuples() != numberOfShapes
+    || (normals && normals->GetNumberOfTuples() != numberOfShapes))
+  {
+    vtkErrorMacro("CreateShapes failed: input arrays must have the same number of tuples");
+    return 0;
+  }
+  
+  int numberOfCreatedShapes = 0;
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  for (vtkIdType i = 0; i < numberOfShapes; i++)
+  {
+    const int shapeType = (int) shapeTypes->GetTuple1(i);
+    double center[3] = { 0.0 };
+    double normal[3] = { 0.0, 0.0, 1.0 };
+    centers->GetTuple(i, center);
+    if (normals)
+    {
+      normals->GetTuple(i, normal);
+    }
+    if (vtkMath::Normalize(normal) == 0.0)
+    {
+      vtkWarningMacro("CreateShapes: zero normal at index " << i << ", shape not created.");
+      continue;
+    }
+    double innerRadius = 0.0;
+    double outerRadius = radii->GetComponent(i, 0);
+    if (shapeType == vtkMRMLMarkupsShapeNode::Disk)
+    {
+      if (radii->GetNumberOfComponents() != 2)
+      {
+        vtkWarningMacro("CreateShapes: a disk needs an inner and an outer radius at index " << i << ", shape not created.");
+        continue;
+      }
+      innerRadius = radii->GetComponent(i, 0);
+      outerRadius = radii->GetComponent(i, 1);
+    }
+    // A disk inner radius point on the center would not define the disk plane.
+    if (outerRadius <= 0.0 || innerRadius < 0.0 || innerRadius >= outerRadius
+      || (shapeType == vtkMRMLMarkupsShapeNode::Disk && innerRadius <= 0.0))
+    {
+      vtkWarningMacro("CreateShapes: invalid radius at index " << i << ", shape not created.");
+      continue;
+    }
+    
+    // Two directions in the shape plane : the shape normal is axis1 x axis2.
+    double axis1[3] = { 0.0 };
+    double axis2[3] = { 0.0 };
+    vtkMath::Perpendiculars(normal, axis1, axis2, 0.0);
+    auto pointAt = [&center](const double * axis, double distance, double * point)
+    {
+      point[0] = center[0] + distance * axis[0];
+      point[1] = center[1] + distance * axis[1];
+      point[2] = center[2] + distance * axis[2];
+    };
+    
+    // Centered radius mode : p1 is always the center.
+    vtkNew<vtkPoints> controlPoints;
+    controlPoints->InsertNextPoint(center);
+    double point[3] = { 0.0 };
+    switch (shapeType)
+    {
+      case vtkMRMLMarkupsShapeNode::Sphere :
+        pointAt(axis1, outerRadius, point);
+        controlPoints->InsertNextPoint(point);
+        break;
+      case vtkMRMLMarkupsShapeNode::Ring :
+        pointAt(axis1, outerRadius, point);
+        controlPoints->InsertNextPoint(point);
+        pointAt(axis2, outerRadius, point);
+        controlPoints->InsertNextPoint(point);
+        break;
+      case vtkMRMLMarkupsShapeNode::Disk :
+        pointAt(axis1, innerRadius, point);
+        controlPoints->InsertNextPoint(point);
+        pointAt(axis2, outerRadius, point);
+        controlPoints->InsertNextPoint(point);
+        break;
+      default :
+        vtkWarningMacro("CreateShapes: unsupported shape type at index " << i << ", shape not created.");
+        continue;
+    }
+    
+    // Not observed yet : no event is processed while the node is filled.
+    vtkNew<vtkMRMLMarkupsShapeNode> shapeNode;
+    shapeNode->SetShapeName(shapeType);
+    shapeNode->SetRadiusMode(vtkMRMLMarkupsShapeNode::Centered);
+    shapeNode->SetControlPointPositionsWorld(controlPoints);
+    shapeNode->SetName(scene->GetUniqueNameByString(shapeNode->GetDefaultNodeNamePrefix()).c_str());
+    scene->AddNode(shapeNode);
+    shapeNode->CreateDefaultDisplayNodes();
+    if (createdNodes)
+    {
+      createdNodes->AddItem(shapeNode);
+    }
+    numberOfCreatedShapes++;
+  }
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+  return numberOfCreatedShapes;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::SetTimingEnabled(bool enabled)
+{
+  vtkShapeTimingCounters::SetEnabled(enabled);
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerShapeLogic::GetTimingEnabled()
+{
+  return vtkShapeTimingCounters::GetEnabled();
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::ResetTimings()
+{
+  vtkShapeTimingCounters::Reset();
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::GetTimings(vtkTable * table)
+{
+  if (!table)
+  {
+    vtkErrorMacro("GetTimings failed: invalid table");
+    return;
+  }
+  vtkShapeTimingCounters::GetTimings(table);
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerShapeLogic::ComputeMeasurements(vtkTable * table, vtkMRMLScene * scene)
+{
+  if (!table)
+  {
+    vtkErrorMacro("ComputeMeasurements failed: invalid table");
+    return 0;
+  }
+  if (!scene)
+  {
+    scene = this->GetMRMLScene();
+  }
+  if (!scene)
+  {
+    vtkErrorMacro("ComputeMeasurements failed: invalid scene");
+    return 0;
+  }
+  vtkNew<vtkStringArray> nodeIDs;
+  nodeIDs->SetName("NodeID");
+  vtkNew<vtkStringArray> names;
+  names->SetName("Name");
+  vtkNew<vtkStringArray> shapes;
+  shapes->SetName("Shape");
+  vtkNew<vtkStringArray> measurementNames;
+  measurementNames->SetName("Measurement");
+  vtkNew<vtkDoubleArray> values;
+  values->SetName("Value");
+  vtkNew<vtkStringArray> units;
+  units->SetName("Unit");
+  vtkNew<vtkIntArray> defined;
+  defined->SetName("Defined");
+  
+  std::vector<vtkMRMLNode*> nodes;
+  scene->GetNodesByClass("vtkMRMLMarkupsShapeNode", nodes);
+  int numberOfShapeNodes = 0;
+  for (vtkMRMLNode * node : nodes)
+  {
+    vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(node);
+    if (!shapeNode)
+    {
+      continue;
+    }
+    numberOfShapeNodes++;
+    const std::string shapeName = (shapeNode->GetShapeName() == vtkMRMLMarkupsShapeNode::Sphere
+                                   && shapeNode->GetSphereSet())
+      ? "SphereSet" : vtkMRMLMarkupsShapeNode::GetShapeNameAsString(shapeNode->GetShapeName());
+    for (int i = 0; i < shapeNode->GetNumberOfMeasurements(); i++)
+    {
+      vtkMRMLMeasurement * measurement = shapeNode->GetNthMeasurement(i);
+      const int measurementType = measurement ? vtkMRMLMeasurementShape::GetMeasurementType(measurement->GetName()) : -1;
+      if (measurementType < 0)
+      {
+        continue;
+      }
+      double value = 0.0;
+      bool valueDefined = shapeNode->GetMeasurementValue(measurementType, value);
+      while (shapeNode->IsMeasurementPending(measurementType))
+      {
+        shapeNode->WaitForAsynchronousMeasurements();
+        valueDefined = shapeNode->GetMeasurementValue(measurementType, value);
+      }
+      const char * unit = "mm";
+      if (measurementType == vtkMRMLMarkupsShapeNode::VolumeMeasurement)
+      {
+        unit = "mm3";
+      }
+      else if (measurementType == vtkMRMLMarkupsShapeNode::AreaMeasurement
+        || measurementType == vtkMRMLMarkupsShapeNode::InnerAreaMeasurement
+        || measurementType == vtkMRMLMarkupsShapeNode::OuterAreaMeasurement)
+      {
+        unit = "mm2";
+      }
+      nodeIDs->InsertNextValue(shapeNode->GetID() ? shapeNode->GetID() : "");
+      names->InsertNextValue(shapeNode->GetName() ? shapeNode->GetName() : "");
+      shapes->InsertNextValue(shapeName);
+      measurementNames->InsertNextValue(measurement->GetName());
+      values->InsertNextValue(value);
+      units->InsertNextValue(unit);
+      defined->InsertNextValue(valueDefined ? 1 : 0);
+    }
+  }
+  table->Initialize();
+  table->AddColumn(nodeIDs);
+  table->AddColumn(names);
+  table->AddColumn(shapes);
+  table->AddColumn(measurementNames);
+  table->AddColumn(values);
+  table->AddColumn(units);
+  table->AddColumn(defined);
+  return numberOfShapeNodes;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::OnMeasurementsReady(void * clientData)
+{
+  // In a worker thread.
+  vtkSlicerShapeLogic * self = reinterpret_cast<vtkSlicerShapeLogic*>(clientData);
+  vtkSlicerApplicationLogic * appLogic = vtkSlicerApplicationLogic::SafeDownCast(self->GetMRMLApplicationLogic());
+  if (!appLogic)
+  {
+    // Without an application, ProcessAsynchronousMeasurements() is called by the user.
+    return;
+  }
+  appLogic->RequestModified(self->MeasurementsReadyProxy);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerShapeLogic::OnMeasurementsReadyProxyModified(vtkObject * caller, unsigned long event,
+                                                           void * clientData, void * callData)
+{
+  vtkSlicerShapeLogic * self = reinterpret_cast<vtkSlicerShapeLogic*>(clientData);
+  vtkMRMLScene * scene = self->GetMRMLScene();
+  if (!scene)
+  {
+    return;
+  }
+  std::vector<vtkMRMLNode*> shapeNodes;
+  scene->GetNodesByClass("vtkMRMLMarkupsShapeNode", shapeNodes);
+  for (vtkMRMLNode * node : shapeNodes)
+  {
+    vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(node);
+    if (shapeNode)
+    {
+      shapeNode->ProcessAsynchronousMeasurements();
+    }
+  }
+}
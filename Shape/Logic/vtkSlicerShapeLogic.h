@@ -23,8 +23,17 @@
 
 #include <vtkSlicerMarkupsLogic.h>
 
+#include <vtkSmartPointer.h>
+
 #include "vtkSlicerShapeModuleLogicExport.h"
 
+class vtkCallbackCommand;
+class vtkCollection;
+class vtkDataArray;
+class vtkMRMLNode;
+class vtkMRMLScene;
+class vtkTable;
+
 class VTK_SLICER_SHAPE_MODULE_LOGIC_EXPORT vtkSlicerShapeLogic:
   public vtkSlicerMarkupsLogic
 {
@@ -33,11 +42,51 @@ public:
   vtkTypeMacro(vtkSlicerShapeLogic, vtkSlicerMarkupsLogic);
   void PrintSelf(ostream& os, vtkIndent indent) override;
 
+  /// Create one shape node per tuple of the input arrays, all in a single scene batch
+  /// processing block. Control points are set at once before each node is added to the scene.
+  /// - centers : 3 components, world coordinates.
+  /// - radii : 1 component, or 2 components (inner radius, outer radius) for disks, with 0 < inner < outer.
+  /// - normals : 3 components, orientation of rings and disks; may be nullptr if there is none.
+  /// - shapeTypes : vtkMRMLMarkupsShapeNode::Sphere, Ring or Disk; Tube is not supported.
+  /// Created nodes are appended to createdNodes if it is not nullptr.
+  /// Returns the number of created nodes.
+  int CreateShapes(vtkDataArray * centers, vtkDataArray * radii, vtkDataArray * normals,
+                   vtkDataArray * shapeTypes, vtkCollection * createdNodes = nullptr);
+
+  /// Timing of the representations, shape generation and measurements, in all views.
+  /// Off by default.
+  void SetTimingEnabled(bool enabled);
+  bool GetTimingEnabled();
+  void ResetTimings();
+  /// One row per stage and shape type :
+  /// Stage, Shape, Calls, TotalMs, MeanMs, MaxMs.
+  void GetTimings(vtkTable * table);
+  
+  /// Evaluate the measurements of all shape nodes of a scene, with no view :
+  /// the nodes generate their geometry on demand. Disabled measurements are included,
+  /// asynchronous measurements are waited for.
+  /// One row per node and measurement : NodeID, Name, Shape, Measurement, Value, Unit, Defined.
+  /// Values are in mm, mm2 and mm3. The logic's scene is used if scene is nullptr.
+  /// Returns the number of shape nodes.
+  int ComputeMeasurements(vtkTable * table, vtkMRMLScene * scene = nullptr);
+
 protected:
   vtkSlicerShapeLogic();
   ~vtkSlicerShapeLogic() override;
 
   void RegisterNodes() override;
+  void SetMRMLSceneInternal(vtkMRMLScene * newScene) override;
+  void OnMRMLSceneNodeAdded(vtkMRMLNode * node) override;
+  void OnMRMLSceneNodeRemoved(vtkMRMLNode * node) override;
+  
+  // Asynchronous shape measurements : the shape nodes of the scene notify this logic,
+  // the proxy is modified in the main thread when they are ready.
+  void SetMeasurementsReadyCallbacks(vtkMRMLScene * scene, bool observe);
+  static void OnMeasurementsReady(void * clientData);
+  static void OnMeasurementsReadyProxyModified(vtkObject * caller, unsigned long event,
+                                               void * clientData, void * callData);
+  vtkSmartPointer<vtkObject> MeasurementsReadyProxy;
+  vtkSmartPointer<vtkCallbackCommand> MeasurementsReadyCallback;
 
 private:
   vtkSlicerShapeLogic(const vtkSlicerShapeLogic&) = delete;
@@ -0,0 +1,78 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#include "vtkMRMLMarkupsShapeDisplayNode.h"
+
+// MRML includes
+#include <vtkMRMLNode.h>
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+//--------------------------------------------------------------------------------
+vtkMRMLNodeNewMacro(vtkMRMLMarkupsShapeDisplayNode);
+
+//--------------------------------------------------------------------------------
+vtkMRMLMarkupsShapeDisplayNode::vtkMRMLMarkupsShapeDisplayNode() = default;
+
+//--------------------------------------------------------------------------------
+vtkMRMLMarkupsShapeDisplayNode::~vtkMRMLMarkupsShapeDisplayNode() = default;
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os,indent);
+  vtkMRMLPrintBeginMacro(os, indent);
+  vtkMRMLPrintFloatMacro(PreviewResolution);
+  vtkMRMLPrintBooleanMacro(SphereImpostors);
+  vtkMRMLPrintEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeDisplayNode::WriteXML(ostream& of, int nIndent)
+{
+  Superclass::WriteXML(of, nIndent);
+  vtkMRMLWriteXMLBeginMacro(of);
+  vtkMRMLWriteXMLFloatMacro(previewResolution, PreviewResolution);
+  vtkMRMLWriteXMLBooleanMacro(sphereImpostors, SphereImpostors);
+  vtkMRMLWriteXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeDisplayNode::ReadXMLAttributes(const char** atts)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::ReadXMLAttributes(atts);
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLFloatMacro(previewResolution, PreviewResolution);
+  vtkMRMLReadXMLBooleanMacro(sphereImpostors, SphereImpostors);
+  vtkMRMLReadXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeDisplayNode::CopyContent(vtkMRMLNode* anode, bool deepCopy/*=true*/)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::CopyContent(anode, deepCopy);
+  vtkMRMLCopyBeginMacro(anode);
+  vtkMRMLCopyFloatMacro(PreviewResolution);
+  vtkMRMLCopyBooleanMacro(SphereImpostors);
+  vtkMRMLCopyEndMacro();
+}
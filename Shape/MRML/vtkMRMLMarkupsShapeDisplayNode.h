@@ -0,0 +1,73 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#ifndef __vtkmrmlmarkupsShape_LOWERdisplaynode_h_
+#define __vtkmrmlmarkupsShape_LOWERdisplaynode_h_
+
+#include <vtkMRMLMarkupsDisplayNode.h>
+
+#include "vtkSlicerShapeModuleMRMLExport.h"
+
+//-----------------------------------------------------------------------------
+class VTK_SLICER_SHAPE_MODULE_MRML_EXPORT vtkMRMLMarkupsShapeDisplayNode
+: public vtkMRMLMarkupsDisplayNode
+{
+public:
+  static vtkMRMLMarkupsShapeDisplayNode* New();
+  vtkTypeMacro(vtkMRMLMarkupsShapeDisplayNode, vtkMRMLMarkupsDisplayNode);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  //--------------------------------------------------------------------------------
+  // MRMLNode methods
+  //--------------------------------------------------------------------------------
+  vtkMRMLNode* CreateNodeInstance() override;
+  /// Get node XML tag name (like Volume, Model)
+  const char* GetNodeTagName() override {return "MarkupsShapeDisplay";}
+
+  /// Read node attributes from XML file
+  void ReadXMLAttributes(const char** atts) override;
+  /// Write this node's information to a MRML file in XML format.
+  void WriteXML(ostream& of, int indent) override;
+
+  /// \sa vtkMRMLNode::CopyContent
+  vtkMRMLCopyContentMacro(vtkMRMLMarkupsShapeDisplayNode);
+
+  /// Resolution used instead of the shape node's resolution while a control point is dragged.
+  /// It is never higher than the shape node's resolution.
+  vtkSetClampMacro(PreviewResolution, double, 3.0, 360.0);
+  vtkGetMacro(PreviewResolution, double);
+  
+  /// Sphere and sphere set : render each sphere in 3D views as a ray cast impostor
+  /// on one quad instead of a tessellated mesh. Off by default.
+  vtkSetMacro(SphereImpostors, bool);
+  vtkGetMacro(SphereImpostors, bool);
+  vtkBooleanMacro(SphereImpostors, bool);
+
+protected:
+  vtkMRMLMarkupsShapeDisplayNode();
+  ~vtkMRMLMarkupsShapeDisplayNode() override;
+  vtkMRMLMarkupsShapeDisplayNode(const vtkMRMLMarkupsShapeDisplayNode&);
+  void operator=(const vtkMRMLMarkupsShapeDisplayNode&);
+
+  double PreviewResolution { 12.0 };
+  bool SphereImpostors { false };
+};
+
+#endif //vtkmrmlmarkupsShape_LOWERdisplaynode_h_
@@ -19,33 +19,133 @@
 ==============================================================================*/
 
 #include "vtkMRMLMarkupsShapeNode.h"
+#include "vtkMRMLMarkupsShapeDisplayNode.h"
 #include "vtkMRMLMeasurementShape.h"
+#include "vtkShapeSegmentedTube.h"
+#include "vtkShapeTubeSweep.h"
+#include "vtkShapeTimingCounters.h"
 
 // VTK includes
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkMRMLScene.h>
 #include <vtkMRMLSliceNode.h>
 #include <vtkCollection.h>
 #include <vtkCallbackCommand.h>
+#include <vtkCellArray.h>
+#include <vtkDiskSource.h>
+#include <vtkDoubleArray.h>
+#include <vtkMassProperties.h>
+#include <vtkParametricFunctionSource.h>
+#include <vtkParametricSpline.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkRegularPolygonSource.h>
+#include <vtkSphereSource.h>
+#include <vtkStripper.h>
+#include <vtkTriangleFilter.h>
+#include <vtkTrivialProducer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
 
 //--------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLMarkupsShapeNode);
 
+//--------------------------------------------------------------------------------
+// Shared with the worker thread, that never accesses the node.
+struct vtkMRMLMarkupsShapeNode::AsynchronousMeasurement
+{
+  vtkSmartPointer<vtkPolyData> Snapshot;
+  vtkMTimeType GeometryVersion { 0 };
+  double SurfaceArea { 0.0 };
+  double Volume { 0.0 };
+  std::atomic<bool> Superseded { false };
+  std::atomic<bool> Ready { false };
+};
+
+// Shared with the worker threads.
+struct vtkMRMLMarkupsShapeNode::MeasurementsReadyNotifier
+{
+  std::mutex Mutex;
+  MeasurementsReadyCallbackType Callback { nullptr };
+  void * ClientData { nullptr };
+};
+
 //--------------------------------------------------------------------------------
 vtkMRMLMarkupsShapeNode::vtkMRMLMarkupsShapeNode()
 {
+  this->DiskSource = vtkSmartPointer<vtkDiskSource>::New();
+  this->MeasurementsReady = std::make_shared<MeasurementsReadyNotifier>();
+  this->RingSource = vtkSmartPointer<vtkRegularPolygonSource>::New();
+  // A one pixel wide line in all views, whatever the zoom factor.
+  this->RingSource->GeneratePolygonOff();
+  this->RingSource->GeneratePolylineOn();
+  this->SphereSource = vtkSmartPointer<vtkSphereSource>::New();
+  
+  this->Spline = vtkSmartPointer<vtkParametricSpline>::New();
+  vtkNew<vtkPoints> points;
+  const double point[3] = { 0.0 };
+  points->InsertNextPoint(point);
+  this->Spline->SetPoints(points);
+  this->SplineFunctionSource = vtkSmartPointer<vtkParametricFunctionSource>::New();
+  this->SplineFunctionSource->SetParametricFunction(this->Spline);
+  this->TubeSplinePoints = vtkSmartPointer<vtkPoints>::New();
+  this->TubeRadius = vtkSmartPointer<vtkDoubleArray>::New();
+  this->TubeRadius->SetName("TubeRadius");
+  this->TubeSamples = vtkSmartPointer<vtkPoints>::New();
+  this->TubeSampleParameters = vtkSmartPointer<vtkDoubleArray>::New();
+  this->TubeCenterlineRadius = vtkSmartPointer<vtkDoubleArray>::New();
+  this->TubeCenterlineRadius->SetName("TubeRadius");
+  this->TubeCenterline = vtkSmartPointer<vtkPolyData>::New();
+  this->TubeCenterline->SetPoints(this->TubeSamples);
+  vtkNew<vtkCellArray> centerlineLines;
+  this->TubeCenterline->SetLines(centerlineLines);
+  this->TubeCenterline->GetPointData()->AddArray(this->TubeCenterlineRadius);
+  this->TubeCenterline->GetPointData()->SetActiveScalars("TubeRadius");
+  this->TubeCenterlinePoints = vtkSmartPointer<vtkDoubleArray>::New();
+  this->TubeCenterlinePoints->SetName("TubeCenterlinePoints");
+  this->TubeCenterlinePoints->SetNumberOfComponents(3);
+  this->TubeCenterlineRadii = vtkSmartPointer<vtkDoubleArray>::New();
+  this->TubeCenterlineRadii->SetName("TubeCenterlineRadii");
+  this->TubeCenterlineArcLength = vtkSmartPointer<vtkDoubleArray>::New();
+  this->TubeCenterlineArcLength->SetName("TubeCenterlineArcLength");
+  this->Tube = vtkSmartPointer<vtkShapeTubeSweep>::New();
+  this->Tube->SetNumberOfSides(20);
+  this->Tube->SetInputConnection(this->SplineFunctionSource->GetOutputPort());
+  this->SegmentedTube = vtkSmartPointer<vtkShapeSegmentedTube>::New();
+  
   this->SetShapeName(Sphere);
   
   this->OnPointPositionUndefinedCallback = vtkSmartPointer<vtkCallbackCommand>::New();
   this->OnPointPositionUndefinedCallback->SetClientData( reinterpret_cast<void *>(this) );
   this->OnPointPositionUndefinedCallback->SetCallback( vtkMRMLMarkupsShapeNode::OnPointPositionUndefined );
   this->AddObserver(vtkMRMLMarkupsNode::PointPositionUndefinedEvent, this->OnPointPositionUndefinedCallback);
+  
+  this->OnInteractionCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->OnInteractionCallback->SetClientData( reinterpret_cast<void *>(this) );
+  this->OnInteractionCallback->SetCallback( vtkMRMLMarkupsShapeNode::OnInteraction );
+  this->AddObserver(vtkMRMLMarkupsNode::PointStartInteractionEvent, this->OnInteractionCallback);
+  this->AddObserver(vtkMRMLMarkupsNode::PointEndInteractionEvent, this->OnInteractionCallback);
+  
+  this->OnPointModifiedCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->OnPointModifiedCallback->SetClientData( reinterpret_cast<void *>(this) );
+  this->OnPointModifiedCallback->SetCallback( vtkMRMLMarkupsShapeNode::OnPointModified );
+  this->AddObserver(vtkMRMLMarkupsNode::PointModifiedEvent, this->OnPointModifiedCallback);
+  this->AddObserver(vtkMRMLMarkupsNode::PointPositionDefinedEvent, this->OnPointModifiedCallback);
 }
 
 //--------------------------------------------------------------------------------
 vtkMRMLMarkupsShapeNode::~vtkMRMLMarkupsShapeNode()
 {
+  // Workers use static state of this library.
+  this->CancelAsynchronousMeasurements();
   this->RemoveObserver(this->OnPointPositionUndefinedCallback);
+  this->RemoveObserver(this->OnInteractionCallback);
+  this->RemoveObserver(this->OnPointModifiedCallback);
 }
 
 //----------------------------------------------------------------------------
@@ -54,15 +154,35 @@ void vtkMRMLMarkupsShapeNode::PrintSelf(ostream& os, vtkIndent indent)
   Superclass::PrintSelf(os,indent);
 }
 
+//----------------------------------------------------------------------------
+const char * vtkMRMLMarkupsShapeNode::GetShapeNameAsString(int shapeName)
+{
+  switch (shapeName)
+  {
+    case Sphere :
+      return "Sphere";
+    case Ring :
+      return "Ring";
+    case Disk :
+      return "Disk";
+    case Tube :
+      return "Tube";
+    default :
+      return "Unknown";
+  };
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLMarkupsShapeNode::SetShapeName(int shapeName)
 {
   this->ShapeName = shapeName;
+  this->ShapeParametersTime.Modified();
   switch (shapeName)
   {
     case Sphere :
-      this->RequiredNumberOfControlPoints = 2;
-      this->MaximumNumberOfControlPoints = 2;
+      // A sphere set is unbounded, like Tube.
+      this->RequiredNumberOfControlPoints = this->SphereSet ? -1 : 2;
+      this->MaximumNumberOfControlPoints = this->SphereSet ? -1 : 2;
       this->ForceSphereMeasurements();
       break;
     case Ring:
@@ -91,6 +211,7 @@ void vtkMRMLMarkupsShapeNode::SetShapeName(int shapeName)
       this->RequiredNumberOfControlPoints = -1;
       this->MaximumNumberOfControlPoints = -1;
       this->ForceTubeMeasurements();
+      break;
     default :
       vtkErrorMacro("Unknown shape.");
       return;
@@ -102,13 +223,333 @@ void vtkMRMLMarkupsShapeNode::SetShapeName(int shapeName)
       this->RemoveNthControlPoint(this->MaximumNumberOfControlPoints);
     }
   }
-  else
+  else if (shapeName == Tube)
   {
     this->RemoveAllControlPoints();
   }
+  this->SnapRingThirdPoint();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetSphereSet(bool sphereSet)
+{
+  if (this->SphereSet == sphereSet)
+  {
+    return;
+  }
+  this->SphereSet = sphereSet;
+  if (this->ShapeName == Sphere)
+  {
+    // Update the number of control points and the measurements.
+    this->SetShapeName(Sphere);
+    return;
+  }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetRadiusMode(int mode)
+{
+  if (this->RadiusMode == mode)
+  {
+    return;
+  }
+  this->RadiusMode = mode;
+  this->ShapeParametersTime.Modified();
+  // The ring center and radius changed.
+  this->SnapRingThirdPoint();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetResolution(double resolution)
+{
+  if (this->Resolution == resolution)
+  {
+    return;
+  }
+  this->Resolution = resolution;
+  // Views will request new levels.
+  this->ShapeWorldCaches.clear();
+  this->ShapeParametersTime.Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetOutputPointsPrecision(int precision)
+{
+  if (this->OutputPointsPrecision == precision)
+  {
+    return;
+  }
+  this->OutputPointsPrecision = precision;
+  this->ShapeWorldCaches.clear();
+  this->ShapeParametersTime.Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetOutputTopology(int topology)
+{
+  if (this->OutputTopology == topology)
+  {
+    return;
+  }
+  this->OutputTopology = topology;
+  this->ShapeWorldCaches.clear();
+  this->ShapeParametersTime.Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetOutputNormals(bool enabled)
+{
+  if (this->OutputNormals == enabled)
+  {
+    return;
+  }
+  this->OutputNormals = enabled;
+  this->ShapeWorldCaches.clear();
+  this->ShapeParametersTime.Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetTubeMeshMeasurements(bool enabled)
+{
+  if (this->TubeMeshMeasurements == enabled)
+  {
+    return;
+  }
+  this->TubeMeshMeasurements = enabled;
+  // Force evaluation.
+  this->MeasurementValuesNumberOfDefinedControlPoints = -1;
+  this->UpdateAllMeasurements();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetAsynchronousMeasurements(bool enabled)
+{
+  if (this->AsynchronousMeasurements == enabled)
+  {
+    return;
+  }
+  this->AsynchronousMeasurements = enabled;
+  if (this->PendingMeasurement)
+  {
+    this->PendingMeasurement->Superseded = true;
+    this->PendingMeasurement.reset();
+  }
+  // Force evaluation.
+  this->MeasurementValuesNumberOfDefinedControlPoints = -1;
+  this->UpdateAllMeasurements();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetMeasurementsReadyCallback(MeasurementsReadyCallbackType callback, void * clientData)
+{
+  std::lock_guard<std::mutex> lock(this->MeasurementsReady->Mutex);
+  this->MeasurementsReady->Callback = callback;
+  this->MeasurementsReady->ClientData = clientData;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::IsMeasurementPending(int measurement)
+{
+  return this->PendingMeasurement
+         && (measurement == AreaMeasurement || measurement == VolumeMeasurement);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::StartAsynchronousMeasurement(vtkPolyData * tubeWorld,
+                                                           std::shared_ptr<AsynchronousMeasurement> previousMeasurement)
+{
+  const vtkMTimeType version = this->GetShapeWorldVersion();
+  if (previousMeasurement && previousMeasurement->GeometryVersion == version)
+  {
+    this->PendingMeasurement = previousMeasurement;
+    return;
+  }
+  if (previousMeasurement)
+  {
+    // It may still run, its result is dropped.
+    previousMeasurement->Superseded = true;
+  }
+  // Forget the workers that have finished.
+  auto& tasks = this->AsynchronousMeasurementTasks;
+  tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [](const std::future<void>& task)
+  {
+    return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }), tasks.end());
+  auto job = std::make_shared<AsynchronousMeasurement>();
+  job->GeometryVersion = version;
+  job->Snapshot = vtkSmartPointer<vtkPolyData>::New();
+  job->Snapshot->DeepCopy(tubeWorld);
+  this->PendingMeasurement = job;
+  
+  const int shapeName = this->ShapeName;
+  std::shared_ptr<MeasurementsReadyNotifier> notifier = this->MeasurementsReady;
+  tasks.push_back(std::async(std::launch::async, [job, shapeName, notifier]()
+  {
+    if (!job->Superseded)
+    {
+      vtkShapeTimingCounters::ScopedTimer timer("MassProperties", shapeName);
+      vtkNew<vtkTriangleFilter> triangleFilter;
+      vtkNew<vtkMassProperties> massProperties;
+      triangleFilter->SetInputData(job->Snapshot);
+      triangleFilter->Update();
+      massProperties->SetInputData(triangleFilter->GetOutput());
+      massProperties->Update();
+      job->SurfaceArea = massProperties->GetSurfaceArea();
+      job->Volume = massProperties->GetVolume();
+    }
+    job->Snapshot = nullptr;
+    job->Ready = true;
+    if (job->Superseded)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(notifier->Mutex);
+    if (notifier->Callback)
+    {
+      notifier->Callback(notifier->ClientData);
+    }
+  }));
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::CancelAsynchronousMeasurements()
+{
+  if (this->PendingMeasurement)
+  {
+    this->PendingMeasurement->Superseded = true;
+    this->PendingMeasurement.reset();
+    // Not published : evaluate again on the next update.
+    this->MeasurementValuesNumberOfDefinedControlPoints = -1;
+  }
+  // A running evaluation cannot be interrupted, superseded ones skip theirs.
+  for (std::future<void>& task : this->AsynchronousMeasurementTasks)
+  {
+    task.wait();
+  }
+  this->AsynchronousMeasurementTasks.clear();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::WaitForAsynchronousMeasurements()
+{
+  for (std::future<void>& task : this->AsynchronousMeasurementTasks)
+  {
+    task.wait();
+  }
+  this->AsynchronousMeasurementTasks.clear();
+  return this->ProcessAsynchronousMeasurements();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::ProcessAsynchronousMeasurements()
+{
+  if (!this->PendingMeasurement || !this->PendingMeasurement->Ready)
+  {
+    return false;
+  }
+  std::shared_ptr<AsynchronousMeasurement> job = this->PendingMeasurement;
+  this->PendingMeasurement.reset();
+  if (job->Superseded || job->GeometryVersion != this->GetShapeWorldVersion()
+    || this->IsOutdated(this->MeasurementValuesBuildTime, this->MeasurementValuesNumberOfDefinedControlPoints))
+  {
+    // Stale : the next evaluation starts again from the current geometry.
+    vtkDebugMacro("Dropping tube mesh measurements of a previous geometry.");
+    return false;
+  }
+  this->MeasurementValues[AreaMeasurement] = job->SurfaceArea;
+  this->MeasurementValues[VolumeMeasurement] = job->Volume;
+  this->MeasurementAvailable[AreaMeasurement] = true;
+  this->MeasurementAvailable[VolumeMeasurement] = true;
+  this->UpdateAllMeasurements();
+  this->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetResolutionMode(int mode)
+{
+  if (this->ResolutionMode == mode)
+  {
+    return;
+  }
+  this->ResolutionMode = mode;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetTubeSamplingMode(int mode)
+{
+  if (this->TubeSamplingMode == mode)
+  {
+    return;
+  }
+  this->TubeSamplingMode = mode;
+  if (mode != SegmentSampling)
+  {
+    this->SegmentedTube->Reset();
+  }
+  this->ShapeParametersTime.Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SetTubeMaximumChordError(double error)
+{
+  error = std::max(error, 0.001);
+  if (this->TubeMaximumChordError == error)
+  {
+    return;
+  }
+  this->TubeMaximumChordError = error;
+  this->ShapeParametersTime.Modified();
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+double vtkMRMLMarkupsShapeNode::GetGeometryResolution()
+{
+  if (!this->InteractionInProgress)
+  {
+    return this->Resolution;
+  }
+  vtkMRMLMarkupsShapeDisplayNode * displayNode = vtkMRMLMarkupsShapeDisplayNode::SafeDownCast(this->GetDisplayNode());
+  const double previewResolution = displayNode ? displayNode->GetPreviewResolution() : 12.0;
+  return std::min(this->Resolution, previewResolution);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::CreateDefaultDisplayNodes()
+{
+  if (this->GetDisplayNode() != nullptr &&
+    vtkMRMLMarkupsShapeDisplayNode::SafeDownCast(this->GetDisplayNode()) != nullptr)
+  {
+    // display node already exists
+    return;
+  }
+  if (this->GetScene() == nullptr)
+  {
+    vtkErrorMacro("vtkMRMLMarkupsShapeNode::CreateDefaultDisplayNodes failed: scene is invalid");
+    return;
+  }
+  vtkMRMLMarkupsShapeDisplayNode* dispNode = vtkMRMLMarkupsShapeDisplayNode::SafeDownCast(
+    this->GetScene()->AddNewNodeByClass("vtkMRMLMarkupsShapeDisplayNode"));
+  if (!dispNode)
+  {
+    vtkErrorMacro("vtkMRMLMarkupsShapeNode::CreateDefaultDisplayNodes failed: scene failed to instantiate a vtkMRMLMarkupsShapeDisplayNode node");
+    return;
+  }
+  this->SetAndObserveDisplayNodeID(dispNode->GetID());
+}
+
 //---------------------- For disk shape -------------------------------------
 bool vtkMRMLMarkupsShapeNode::DescribeDiskPointSpacing(double * closestPoint, double * farthestPoint,
                                                      double& innerRadius, double& outerRadius)
@@ -194,6 +635,8 @@ void vtkMRMLMarkupsShapeNode::SetRadius(double radius)
   double rasP2Shifted[3] = { 0.0 };
   this->FindLinearCoordinateByDistance(rasP1, rasP2, rasP2Shifted, difference);
   
+  // One update for both points.
+  MRMLNodeModifyBlocker blocker(this);
   this->SetNthControlPointPositionWorld(1, rasP2Shifted);
   // Don't move center, move p1.
   if (this->RadiusMode == Circumferential)
@@ -202,6 +645,8 @@ void vtkMRMLMarkupsShapeNode::SetRadius(double radius)
     this->FindLinearCoordinateByDistance(rasP2, rasP1, rasP1Shifted, difference);
     this->SetNthControlPointPositionWorld(0, rasP1Shifted);
   }
+  // Within the same update, instead of after it.
+  this->SnapRingThirdPoint();
   // Text actor does not move until mouse is hovered on a control point.
 }
 
@@ -437,12 +882,13 @@ void vtkMRMLMarkupsShapeNode::ForceSphereMeasurements()
 {
   this->RemoveAllMeasurements();
   
+  // A sphere set has no single radius, see GetNthSphereMeasurementValue().
   vtkNew<vtkMRMLMeasurementShape> radiusMeasurement;
   radiusMeasurement->SetName("radius");
   radiusMeasurement->SetUnits("mm");
   radiusMeasurement->SetPrintFormat("%-#4.4g%s");
   radiusMeasurement->SetInputMRMLNode(this);
-  radiusMeasurement->SetEnabled(true);
+  radiusMeasurement->SetEnabled(!this->SphereSet);
   this->Measurements->AddItem(radiusMeasurement);
   
   vtkNew<vtkMRMLMeasurementShape> areaMeasurement;
@@ -460,7 +906,7 @@ void vtkMRMLMarkupsShapeNode::ForceSphereMeasurements()
   volumeMeasurement->SetDisplayCoefficient(0.01);
   volumeMeasurement->SetPrintFormat("%-#4.4g%s");
   volumeMeasurement->SetInputMRMLNode(this);
-  volumeMeasurement->SetEnabled(false);
+  volumeMeasurement->SetEnabled(this->SphereSet);
   this->Measurements->AddItem(volumeMeasurement);
 }
 
@@ -490,18 +936,22 @@ void vtkMRMLMarkupsShapeNode::ForceTubeMeasurements()
 
 //----------------------------------------------------------------------------
 /*
- * Tube : remove an adjacent point.
+ * Tube, sphere set : remove an adjacent point.
  * Toggling a point status in the markups module complicates things, don't react here.
  */
 void vtkMRMLMarkupsShapeNode::OnPointPositionUndefined(vtkObject* caller, unsigned long event, void* clientData, void* callData)
 {
   vtkMRMLMarkupsShapeNode * client = reinterpret_cast<vtkMRMLMarkupsShapeNode*>(clientData);
-  if (!client || client->GetShapeName() != Tube
+  if (!client || !client->HasControlPointPairs()
       || client->GetNumberOfUndefinedControlPoints() > 0)
   {
     return;
   }
   
+  if (client->SettingTubeProfile)
+  {
+    return;
+  }
   if (client->RemovingPairControlPoint || client->GetNumberOfControlPoints() == 0)
   {
     // Point removal was triggered by this function, not in UI.
@@ -509,6 +959,11 @@ void vtkMRMLMarkupsShapeNode::OnPointPositionUndefined(vtkObject* caller, unsign
     return;
   }
   
+  // Events deferred by a modify blocker have no call data.
+  if (!callData)
+  {
+    return;
+  }
   const int removedIndex = *(static_cast<int*> (callData));
   if ((removedIndex % 2) == 0 )
   {
@@ -599,6 +1054,8 @@ void vtkMRMLMarkupsShapeNode::SetRadiusAtNthControlPoint(int n, double radius)
   this->FindLinearCoordinateByDistance(middlePoint, p1, p1New, radiusDifference);
   this->FindLinearCoordinateByDistance(middlePoint, p2, p2New, radiusDifference);
   
+  // One update for both points.
+  MRMLNodeModifyBlocker blocker(this);
   if ((n % 2) == 0)
   {
     this->SetNthControlPointPositionWorld(n, p1New);
@@ -610,3 +1067,1359 @@ void vtkMRMLMarkupsShapeNode::SetRadiusAtNthControlPoint(int n, double radius)
     this->SetNthControlPointPositionWorld(n - 1, p1New);
   }
 }
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::SetTubeRadii(vtkDoubleArray * radii)
+{
+  if (this->GetShapeName() != Tube)
+  {
+    vtkErrorMacro("Not a Tube shape.");
+    return false;
+  }
+  const int numberOfControlPoints = this->GetNumberOfControlPoints();
+  if (numberOfControlPoints < 4
+    || this->GetNumberOfUndefinedControlPoints() > 0
+    || (numberOfControlPoints % 2) != 0)
+  {
+    vtkErrorMacro("Tube shape has undefined control points, or odd number of control points,"
+                  " or less than 4 control points.");
+    return false;
+  }
+  if (!radii || radii->GetNumberOfComponents() != 1
+    || radii->GetNumberOfTuples() != (numberOfControlPoints / 2))
+  {
+    vtkErrorMacro("One radius per control point pair is required.");
+    return false;
+  }
+  vtkNew<vtkPoints> positions;
+  positions->SetNumberOfPoints(numberOfControlPoints);
+  for (int i = 0; i < numberOfControlPoints; i = i + 2)
+  {
+    const double radius = radii->GetValue(i / 2);
+    if (radius <= 0.0)
+    {
+      vtkErrorMacro("Requested radius must be greater than 0.0.");
+      return false;
+    }
+    double p1[3] = { 0.0 };
+    double p2[3] = { 0.0 };
+    this->GetNthControlPointPositionWorld(i, p1);
+    this->GetNthControlPointPositionWorld(i + 1, p2);
+    const double middlePoint[3] = { (p1[0] + p2[0]) / 2.0,
+                                    (p1[1] + p2[1]) / 2.0,
+                                    (p1[2] + p2[2]) / 2.0 };
+    double direction[3] = { p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2] };
+    if (vtkMath::Normalize(direction) == 0.0)
+    {
+      vtkErrorMacro("Control point pair " << (i / 2) << " has coincident points.");
+      return false;
+    }
+    positions->SetPoint(i, middlePoint[0] - radius * direction[0],
+                           middlePoint[1] - radius * direction[1],
+                           middlePoint[2] - radius * direction[2]);
+    positions->SetPoint(i + 1, middlePoint[0] + radius * direction[0],
+                               middlePoint[1] + radius * direction[1],
+                               middlePoint[2] + radius * direction[2]);
+  }
+  MRMLNodeModifyBlocker blocker(this);
+  this->SetControlPointPositionsWorld(positions);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::SetTubeProfile(vtkPoints * centerline, vtkDoubleArray * radii)
+{
+  if (this->GetShapeName() != Tube)
+  {
+    vtkErrorMacro("Not a Tube shape.");
+    return false;
+  }
+  if (!centerline || !radii || centerline->GetNumberOfPoints() < 2
+    || radii->GetNumberOfComponents() != 1
+    || radii->GetNumberOfTuples() != centerline->GetNumberOfPoints())
+  {
+    vtkErrorMacro("At least 2 centerline points are required, with one radius per point.");
+    return false;
+  }
+  const vtkIdType numberOfPoints = centerline->GetNumberOfPoints();
+  vtkNew<vtkPoints> positions;
+  positions->SetNumberOfPoints(2 * numberOfPoints);
+  double direction[3] = { 0.0 };
+  for (vtkIdType i = 0; i < numberOfPoints; i++)
+  {
+    const double radius = radii->GetValue(i);
+    if (radius <= 0.0)
+    {
+      vtkErrorMacro("Requested radius must be greater than 0.0.");
+      return false;
+    }
+    double previous[3] = { 0.0 };
+    double next[3] = { 0.0 };
+    centerline->GetPoint(std::max<vtkIdType>(i - 1, 0), previous);
+    centerline->GetPoint(std::min<vtkIdType>(i + 1, numberOfPoints - 1), next);
+    double tangent[3] = { next[0] - previous[0], next[1] - previous[1], next[2] - previous[2] };
+    if (vtkMath::Normalize(tangent) == 0.0)
+    {
+      vtkErrorMacro("Centerline point " << i << " coincides with its neighbours.");
+      return false;
+    }
+    // Previous direction, made perpendicular to the local tangent.
+    const double alongTangent = vtkMath::Dot(direction, tangent);
+    direction[0] -= alongTangent * tangent[0];
+    direction[1] -= alongTangent * tangent[1];
+    direction[2] -= alongTangent * tangent[2];
+    if (vtkMath::Normalize(direction) < 1e-6)
+    {
+      double unused[3] = { 0.0 };
+      vtkMath::Perpendiculars(tangent, direction, unused, 0.0);
+    }
+    double center[3] = { 0.0 };
+    centerline->GetPoint(i, center);
+    positions->SetPoint(2 * i, center[0] - radius * direction[0],
+                               center[1] - radius * direction[1],
+                               center[2] - radius * direction[2]);
+    positions->SetPoint(2 * i + 1, center[0] + radius * direction[0],
+                                   center[1] + radius * direction[1],
+                                   center[2] + radius * direction[2]);
+  }
+  MRMLNodeModifyBlocker blocker(this);
+  // Surplus points are removed by pairs already.
+  this->SettingTubeProfile = true;
+  this->SetControlPointPositionsWorld(positions);
+  this->SettingTubeProfile = false;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::HasControlPointPairs()
+{
+  return this->ShapeName == Tube || (this->ShapeName == Sphere && this->SphereSet);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::DescribeSphereAtControlPointPair(int firstIndex, double * center, double& radius)
+{
+  if (firstIndex < 0 || (firstIndex + 1) >= this->GetNumberOfControlPoints())
+  {
+    return false;
+  }
+  for (int i = firstIndex; i <= firstIndex + 1; i++)
+  {
+    const int status = this->GetNthControlPointPositionStatus(i);
+    if (status != vtkMRMLMarkupsNode::PositionDefined && status != vtkMRMLMarkupsNode::PositionPreview)
+    {
+      return false;
+    }
+  }
+  double p1[3] = { 0.0 };
+  double p2[3] = { 0.0 };
+  this->GetNthControlPointPositionWorld(firstIndex, p1);
+  this->GetNthControlPointPositionWorld(firstIndex + 1, p2);
+  const double lineLength = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
+  if (this->RadiusMode == Centered)
+  {
+    center[0] = p1[0];
+    center[1] = p1[1];
+    center[2] = p1[2];
+    radius = lineLength;
+  }
+  else
+  {
+    center[0] = (p1[0] + p2[0]) / 2.0;
+    center[1] = (p1[1] + p2[1]) / 2.0;
+    center[2] = (p1[2] + p2[2]) / 2.0;
+    radius = lineLength / 2.0;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLMarkupsShapeNode::GetNumberOfSpheres()
+{
+  if (this->ShapeName != Sphere || !this->SphereSet)
+  {
+    return 0;
+  }
+  int numberOfSpheres = 0;
+  double center[3] = { 0.0 };
+  double radius = 0.0;
+  for (int i = 0; i < this->GetNumberOfControlPoints(); i = i + 2)
+  {
+    if (this->DescribeSphereAtControlPointPair(i, center, radius))
+    {
+      numberOfSpheres++;
+    }
+  }
+  return numberOfSpheres;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::DescribeNthSphere(int n, double * center, double& radius)
+{
+  if (this->ShapeName != Sphere || !this->SphereSet)
+  {
+    vtkErrorMacro("Not a sphere set.");
+    return false;
+  }
+  int sphereIndex = 0;
+  for (int i = 0; i < this->GetNumberOfControlPoints(); i = i + 2)
+  {
+    if (this->DescribeSphereAtControlPointPair(i, center, radius))
+    {
+      if (sphereIndex == n)
+      {
+        return true;
+      }
+      sphereIndex++;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::GetNthSphereMeasurementValue(int n, int measurement, double& value)
+{
+  double center[3] = { 0.0 };
+  double radius = 0.0;
+  if (!this->DescribeNthSphere(n, center, radius))
+  {
+    return false;
+  }
+  switch (measurement)
+  {
+    case RadiusMeasurement :
+      value = radius;
+      return true;
+    case AreaMeasurement :
+      value = 4.0 * vtkMath::Pi() * radius * radius;
+      return true;
+    case VolumeMeasurement :
+      value = (4.0 / 3.0) * vtkMath::Pi() * radius * radius * radius;
+      return true;
+    default :
+      return false;
+  };
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLMarkupsShapeNode::GetSphereIndexAtPositionWorld(const double * position)
+{
+  if (this->ShapeName != Sphere || !this->SphereSet)
+  {
+    vtkErrorMacro("Not a sphere set.");
+    return -1;
+  }
+  // Smallest distance to center minus radius : innermost containing sphere, else closest surface.
+  int closestSphere = -1;
+  double closestDistance = VTK_DOUBLE_MAX;
+  int sphereIndex = 0;
+  double center[3] = { 0.0 };
+  double radius = 0.0;
+  for (int i = 0; i < this->GetNumberOfControlPoints(); i = i + 2)
+  {
+    if (!this->DescribeSphereAtControlPointPair(i, center, radius))
+    {
+      continue;
+    }
+    const double distance = std::sqrt(vtkMath::Distance2BetweenPoints(position, center)) - radius;
+    if (distance < closestDistance)
+    {
+      closestDistance = distance;
+      closestSphere = sphereIndex;
+    }
+    sphereIndex++;
+  }
+  return closestSphere;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLMarkupsShapeNode::ShapeWorldCache& vtkMRMLMarkupsShapeNode::GetShapeWorldCache(int resolution)
+{
+  ShapeWorldCache& cache = this->ShapeWorldCaches[resolution];
+  if (!cache.ShapeWorld)
+  {
+    cache.ShapeWorld = vtkSmartPointer<vtkPolyData>::New();
+    cache.Producer = vtkSmartPointer<vtkTrivialProducer>::New();
+    cache.Producer->SetOutput(cache.ShapeWorld);
+  }
+  return cache;
+}
+
+//----------------------------------------------------------------------------
+vtkPolyData * vtkMRMLMarkupsShapeNode::GetShapeWorld()
+{
+  return this->GetShapeWorld((int) this->GetGeometryResolution());
+}
+
+//----------------------------------------------------------------------------
+vtkPolyData * vtkMRMLMarkupsShapeNode::GetShapeWorld(int resolution)
+{
+  this->UpdateShapeWorld(resolution);
+  return this->GetShapeWorldCache(resolution).ShapeWorld;
+}
+
+//----------------------------------------------------------------------------
+vtkAlgorithmOutput * vtkMRMLMarkupsShapeNode::GetShapeWorldConnection()
+{
+  return this->GetShapeWorldConnection((int) this->GetGeometryResolution());
+}
+
+//----------------------------------------------------------------------------
+vtkAlgorithmOutput * vtkMRMLMarkupsShapeNode::GetShapeWorldConnection(int resolution)
+{
+  return this->GetShapeWorldCache(resolution).Producer->GetOutputPort();
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkMRMLMarkupsShapeNode::GetShapeWorldVersion()
+{
+  return this->GetShapeWorldVersion((int) this->GetGeometryResolution());
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkMRMLMarkupsShapeNode::GetShapeWorldVersion(int resolution)
+{
+  return this->GetShapeWorldCache(resolution).BuildTime.GetMTime();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLMarkupsShapeNode::GetViewResolution(double viewScaleFactorMmPerPixel)
+{
+  const int maximumResolution = (int) this->GetGeometryResolution();
+  if (this->ResolutionMode != AutomaticResolution || viewScaleFactorMmPerPixel <= 0.0)
+  {
+    return maximumResolution;
+  }
+  const double radius = this->GetMaximumShapeRadius();
+  if (radius <= 0.0)
+  {
+    return maximumResolution;
+  }
+  // Sides needed for a maximum deviation of half a pixel from the true circle.
+  const double maximumDeviation = 0.5;
+  const double radiusPixel = radius / viewScaleFactorMmPerPixel;
+  int sides = 0;
+  if (radiusPixel > maximumDeviation)
+  {
+    const double sideAngle = 2.0 * std::acos(1.0 - maximumDeviation / radiusPixel);
+    sides = (int) std::ceil(2.0 * vtkMath::Pi() / sideAngle);
+  }
+  // Few levels, to share them between views and not regenerate on each zoom step.
+  int level = 8;
+  while (level < sides && level < maximumResolution)
+  {
+    level *= 2;
+  }
+  return std::max(3, std::min(level, maximumResolution));
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::GetShapeWorldBoundingSphere(double * center, double& radius)
+{
+  if (this->IsOutdated(this->BoundingSphereBuildTime, this->BoundingSphereNumberOfDefinedControlPoints))
+  {
+    this->BoundingSphereBuildTime.Modified();
+    this->BoundingSphereNumberOfDefinedControlPoints = this->GetNumberOfDefinedControlPoints(true);
+    this->BoundingSphereDefined = this->ComputeShapeWorldBoundingSphere(this->BoundingSphere,
+                                                                        this->BoundingSphere[3]);
+  }
+  center[0] = this->BoundingSphere[0];
+  center[1] = this->BoundingSphere[1];
+  center[2] = this->BoundingSphere[2];
+  radius = this->BoundingSphere[3];
+  return this->BoundingSphereDefined;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::ComputeShapeWorldBoundingSphere(double * center, double& radius)
+{
+  double bounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  // Sphere set and Tube : bounds of the spheres, or of the centerline, grown by the largest radius.
+  double margin = 0.0;
+  if (this->ShapeName == Sphere && this->SphereSet)
+  {
+    double sphereCenter[3] = { 0.0 };
+    double sphereRadius = 0.0;
+    for (int i = 0; i < this->GetNumberOfControlPoints(); i = i + 2)
+    {
+      if (!this->DescribeSphereAtControlPointPair(i, sphereCenter, sphereRadius))
+      {
+        continue;
+      }
+      for (int j = 0; j < 3; j++)
+      {
+        bounds[2 * j] = std::min(bounds[2 * j], sphereCenter[j] - sphereRadius);
+        bounds[2 * j + 1] = std::max(bounds[2 * j + 1], sphereCenter[j] + sphereRadius);
+      }
+    }
+  }
+  else if (this->ShapeName == Tube)
+  {
+    // The centerline does not depend on the resolution.
+    vtkPolyData * centerline = this->UpdateTubeCenterline();
+    vtkDataArray * radii = centerline ? centerline->GetPointData()->GetArray("TubeRadius") : nullptr;
+    if (!radii || centerline->GetNumberOfPoints() == 0)
+    {
+      return false;
+    }
+    centerline->GetPoints()->GetBounds(bounds);
+    // Surface between samples.
+    margin = radii->GetRange(0)[1] + this->TubeMaximumChordError;
+  }
+  else
+  {
+    double normal[3] = { 0.0 };
+    double innerRadius = 0.0;
+    return this->DescribeShapeWorld(center, normal, radius, innerRadius);
+  }
+  if (bounds[0] > bounds[1])
+  {
+    return false;
+  }
+  double halfDiagonal = 0.0;
+  for (int j = 0; j < 3; j++)
+  {
+    center[j] = (bounds[2 * j] + bounds[2 * j + 1]) / 2.0;
+    const double halfSize = (bounds[2 * j + 1] - bounds[2 * j]) / 2.0;
+    halfDiagonal += halfSize * halfSize;
+  }
+  radius = std::sqrt(halfDiagonal) + margin;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLMarkupsShapeNode::GetMaximumShapeRadius()
+{
+  if (this->ShapeName == Sphere && this->SphereSet)
+  {
+    double maximumRadius = 0.0;
+    double center[3] = { 0.0 };
+    double radius = 0.0;
+    for (int i = 0; i < this->GetNumberOfControlPoints(); i = i + 2)
+    {
+      if (this->DescribeSphereAtControlPointPair(i, center, radius))
+      {
+        maximumRadius = std::max(maximumRadius, radius);
+      }
+    }
+    return maximumRadius;
+  }
+  if (this->ShapeName == Tube)
+  {
+    // As the bounding sphere : 0 while the tube is incomplete, without errors.
+    vtkPolyData * centerline = this->UpdateTubeCenterline();
+    vtkDataArray * radii = centerline ? centerline->GetPointData()->GetArray("TubeRadius") : nullptr;
+    if (!radii || radii->GetNumberOfTuples() == 0)
+    {
+      return 0.0;
+    }
+    return radii->GetRange(0)[1];
+  }
+  double center[3] = { 0.0 };
+  double normal[3] = { 0.0 };
+  double radius = 0.0, innerRadius = 0.0;
+  if (!this->DescribeShapeWorld(center, normal, radius, innerRadius))
+  {
+    return 0.0;
+  }
+  return radius;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::OnInteraction(vtkObject* caller, unsigned long event, void* clientData, void* callData)
+{
+  vtkMRMLMarkupsShapeNode * client = reinterpret_cast<vtkMRMLMarkupsShapeNode*>(clientData);
+  if (!client)
+  {
+    return;
+  }
+  const bool interactionInProgress = (event == vtkMRMLMarkupsNode::PointStartInteractionEvent);
+  if (client->InteractionInProgress == interactionInProgress)
+  {
+    return;
+  }
+  client->InteractionInProgress = interactionInProgress;
+  // Nothing to regenerate if the preview does not lower the resolution.
+  vtkMRMLMarkupsShapeDisplayNode * displayNode = vtkMRMLMarkupsShapeDisplayNode::SafeDownCast(client->GetDisplayNode());
+  if (displayNode && displayNode->GetPreviewResolution() >= client->GetResolution())
+  {
+    return;
+  }
+  client->ShapeParametersTime.Modified();
+  if (!interactionInProgress)
+  {
+    // Regenerate once at full resolution in all views.
+    client->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::OnPointModified(vtkObject* caller, unsigned long event, void* clientData, void* callData)
+{
+  vtkMRMLMarkupsShapeNode * client = reinterpret_cast<vtkMRMLMarkupsShapeNode*>(clientData);
+  if (!client || client->GetShapeName() != Ring)
+  {
+    return;
+  }
+  client->SnapRingThirdPoint();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SnapRingThirdPoint()
+{
+  // Moving p3 below fires PointModifiedEvent again.
+  if (this->ShapeName != Ring || this->SnappingRingThirdPoint
+    || this->GetNumberOfDefinedControlPoints() != 3)
+  {
+    return;
+  }
+  double center[3] = { 0.0 };
+  double normal[3] = { 0.0 }; // Unused here
+  double radius = 0.0, innerRadius = 0.0;
+  if (!this->DescribeShapeWorld(center, normal, radius, innerRadius))
+  {
+    return;
+  }
+  double p3[3] = { 0.0 };
+  this->GetNthControlPointPositionWorld(2, p3);
+  // p3 defines the ring plane with p2 : its projection on the circle is along the radial direction.
+  double radial[3] = { p3[0] - center[0], p3[1] - center[1], p3[2] - center[2] };
+  const double distance = vtkMath::Normalize(radial);
+  if (distance == 0.0 || std::abs(distance - radius) <= radius * 1e-9)
+  {
+    return;
+  }
+  const double snapped[3] = { center[0] + radius * radial[0],
+                              center[1] + radius * radial[1],
+                              center[2] + radius * radial[2] };
+  this->SnappingRingThirdPoint = true;
+  this->SetNthControlPointPositionWorld(2, snapped);
+  this->SnappingRingThirdPoint = false;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::IsOutdated(const vtkTimeStamp& buildTime, int numberOfDefinedControlPoints)
+{
+  if (buildTime.GetMTime() < this->ShapeParametersTime.GetMTime())
+  {
+    return true;
+  }
+  // Control points in world coordinates, with parent transforms applied.
+  vtkPolyData * curveWorld = this->GetCurveWorld();
+  if (curveWorld && buildTime.GetMTime() < curveWorld->GetMTime())
+  {
+    return true;
+  }
+  // Placing, unplacing or restoring a point.
+  return numberOfDefinedControlPoints != this->GetNumberOfDefinedControlPoints(true);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::UpdateShapeWorld()
+{
+  this->UpdateShapeWorld((int) this->GetGeometryResolution());
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::UpdateShapeWorld(int resolution)
+{
+  ShapeWorldCache& cache = this->GetShapeWorldCache(resolution);
+  if (!this->IsOutdated(cache.BuildTime, cache.NumberOfDefinedControlPoints))
+  {
+    return;
+  }
+  cache.NumberOfDefinedControlPoints = this->GetNumberOfDefinedControlPoints(true);
+  vtkShapeTimingCounters::ScopedTimer timer("ShapeWorld", this->ShapeName);
+  
+  vtkPolyData * shapeWorld = cache.ShapeWorld;
+  bool defined = false;
+  switch (this->ShapeName)
+  {
+    case Sphere :
+      defined = this->SphereSet ? this->UpdateSphereSetWorld(shapeWorld)
+                                : this->UpdateSphereWorld(shapeWorld, resolution);
+      break;
+    case Ring:
+      defined = this->UpdateRingWorld(shapeWorld, resolution);
+      break;
+    case Disk:
+      defined = this->UpdateDiskWorld(shapeWorld, resolution);
+      break;
+    case Tube:
+      defined = this->UpdateTubeWorld(shapeWorld, resolution);
+      break;
+    default :
+      vtkErrorMacro("Unknown shape.");
+      break;
+  };
+  if (!defined)
+  {
+    shapeWorld->Initialize();
+  }
+  else
+  {
+    this->CompactShapeWorld(shapeWorld);
+  }
+  shapeWorld->Modified();
+  cache.BuildTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::GetMeasurementValue(int measurement, double& value)
+{
+  if (measurement < 0 || measurement >= Measurement_Last)
+  {
+    return false;
+  }
+  this->UpdateMeasurementValues();
+  value = this->MeasurementValues[measurement];
+  return this->MeasurementAvailable[measurement];
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::UpdateMeasurementValues()
+{
+  if (!this->IsOutdated(this->MeasurementValuesBuildTime, this->MeasurementValuesNumberOfDefinedControlPoints))
+  {
+    return;
+  }
+  this->MeasurementValuesBuildTime.Modified();
+  this->MeasurementValuesNumberOfDefinedControlPoints = this->GetNumberOfDefinedControlPoints(true);
+  // Reused below if the tube mesh has not changed, else its result is not published.
+  std::shared_ptr<AsynchronousMeasurement> previousMeasurement = std::move(this->PendingMeasurement);
+  this->PendingMeasurement.reset();
+  
+  double * values = this->MeasurementValues;
+  bool * available = this->MeasurementAvailable;
+  // Kept while asynchronous measurements are pending.
+  const double previousValues[2] = { values[AreaMeasurement], values[VolumeMeasurement] };
+  const bool previousAvailable = available[AreaMeasurement] && available[VolumeMeasurement];
+  for (int i = 0; i < Measurement_Last; i++)
+  {
+    values[i] = 0.0;
+    available[i] = false;
+  }
+  
+  if (this->ShapeName == Sphere && this->SphereSet)
+  {
+    // Totals; each sphere is available with GetNthSphereMeasurementValue().
+    double center[3] = { 0.0 };
+    double radius = 0.0;
+    for (int i = 0; i < this->GetNumberOfControlPoints(); i = i + 2)
+    {
+      if (this->DescribeSphereAtControlPointPair(i, center, radius))
+      {
+        values[AreaMeasurement] += 4.0 * vtkMath::Pi() * radius * radius;
+        values[VolumeMeasurement] += (4.0 / 3.0) * vtkMath::Pi() * radius * radius * radius;
+        available[AreaMeasurement] = true;
+        available[VolumeMeasurement] = true;
+      }
+    }
+    return;
+  }
+  
+  switch (this->ShapeName)
+  {
+    case Sphere :
+    case Ring :
+    {
+      // The radius does not depend on the third point of a ring.
+      if (this->GetNumberOfDefinedControlPoints(true) < 2)
+      {
+        return;
+      }
+      double p1[3] = { 0.0 };
+      double p2[3] = { 0.0 };
+      this->GetNthControlPointPositionWorld(0, p1);
+      this->GetNthControlPointPositionWorld(1, p2);
+      const double lineLength = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
+      const double radius = (this->RadiusMode == Centered) ? lineLength : lineLength / 2.0;
+      values[RadiusMeasurement] = radius;
+      available[RadiusMeasurement] = true;
+      available[AreaMeasurement] = true;
+      if (this->ShapeName == Ring)
+      {
+        values[AreaMeasurement] = vtkMath::Pi() * radius * radius;
+      }
+      else
+      {
+        values[AreaMeasurement] = 4.0 * vtkMath::Pi() * radius * radius;
+        values[VolumeMeasurement] = (4.0 / 3.0) * vtkMath::Pi() * radius * radius * radius;
+        available[VolumeMeasurement] = true;
+      }
+      break;
+    }
+    case Disk :
+    {
+      double closestPoint[3] = { 0.0 }; // Unused here
+      double farthestPoint[3] = { 0.0 };
+      double innerRadius = 0.0, outerRadius = 0.0;
+      if (!this->DescribeDiskPointSpacing(closestPoint, farthestPoint, innerRadius, outerRadius))
+      {
+        vtkDebugMacro("Point proximity description failure.");
+        return;
+      }
+      // vtkMassProperties fails here : <Input data type must be VTK_TRIANGLE not 9>.
+      const double innerArea = vtkMath::Pi() * innerRadius * innerRadius;
+      const double outerArea = vtkMath::Pi() * outerRadius * outerRadius;
+      values[InnerRadiusMeasurement] = innerRadius;
+      values[OuterRadiusMeasurement] = outerRadius;
+      values[WidthMeasurement] = outerRadius - innerRadius;
+      values[AreaMeasurement] = outerArea - innerArea;
+      values[InnerAreaMeasurement] = innerArea;
+      values[OuterAreaMeasurement] = outerArea;
+      for (int measurement : { InnerRadiusMeasurement, OuterRadiusMeasurement, WidthMeasurement,
+                               AreaMeasurement, InnerAreaMeasurement, OuterAreaMeasurement })
+      {
+        available[measurement] = true;
+      }
+      break;
+    }
+    case Tube :
+    {
+      double lateralArea = 0.0, volume = 0.0;
+      if (!this->TubeMeshMeasurements)
+      {
+        if (!this->IntegrateTubeCenterline(lateralArea, volume))
+        {
+          return;
+        }
+        values[AreaMeasurement] = lateralArea;
+        values[VolumeMeasurement] = volume;
+        available[AreaMeasurement] = true;
+        available[VolumeMeasurement] = true;
+        break;
+      }
+      // Cross-check : measure the tube mesh, depends on Resolution.
+      vtkPolyData * tubeWorld = this->GetShapeWorld();
+      if (tubeWorld->GetNumberOfPoints() == 0)
+      {
+        return;
+      }
+      if (this->AsynchronousMeasurements)
+      {
+        this->StartAsynchronousMeasurement(tubeWorld, previousMeasurement);
+        values[AreaMeasurement] = previousValues[0];
+        values[VolumeMeasurement] = previousValues[1];
+        available[AreaMeasurement] = previousAvailable;
+        available[VolumeMeasurement] = previousAvailable;
+        break;
+      }
+      // One pass for all measurements.
+      vtkShapeTimingCounters::ScopedTimer timer("MassProperties", this->ShapeName);
+      vtkNew<vtkTriangleFilter> triangleFilter;
+      vtkNew<vtkMassProperties> massProperties;
+      triangleFilter->SetInputData(tubeWorld);
+      triangleFilter->Update();
+      massProperties->SetInputData(triangleFilter->GetOutput());
+      massProperties->Update();
+      values[AreaMeasurement] = massProperties->GetSurfaceArea();
+      values[VolumeMeasurement] = massProperties->GetVolume();
+      if (this->IntegrateTubeCenterline(lateralArea, volume))
+      {
+        vtkDebugMacro("Tube mesh area : " << values[AreaMeasurement] << ", integrated : " << lateralArea
+                      << "; mesh volume : " << values[VolumeMeasurement] << ", integrated : " << volume);
+      }
+      available[AreaMeasurement] = true;
+      available[VolumeMeasurement] = true;
+      break;
+    }
+    default :
+      break;
+  };
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::DescribeShapeWorld(double * center, double * normal,
+                                                 double& radius, double& innerRadius)
+{
+  double p1[3] = { 0.0 };
+  double p2[3] = { 0.0 };
+  double p3[3] = { 0.0 };
+  innerRadius = 0.0;
+  normal[0] = normal[1] = normal[2] = 0.0;
+  if (this->ShapeName == Sphere && this->SphereSet)
+  {
+    // See DescribeNthSphere().
+    return false;
+  }
+  switch (this->ShapeName)
+  {
+    case Sphere :
+    case Ring :
+    {
+      const int numberOfPoints = (this->ShapeName == Sphere) ? 2 : 3;
+      if (this->GetNumberOfDefinedControlPoints(true) != numberOfPoints)
+      {
+        return false;
+      }
+      this->GetNthControlPointPositionWorld(0, p1);
+      this->GetNthControlPointPositionWorld(1, p2);
+      const double lineLength = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
+      // Centered mode : p1 is center, line length is radius.
+      if (this->RadiusMode == Centered)
+      {
+        center[0] = p1[0];
+        center[1] = p1[1];
+        center[2] = p1[2];
+        radius = lineLength;
+      }
+      // Circumferential mode : center is half way between p1 and p2, radius is half of line length.
+      else
+      {
+        center[0] = (p1[0] + p2[0]) / 2.0;
+        center[1] = (p1[1] + p2[1]) / 2.0;
+        center[2] = (p1[2] + p2[2]) / 2.0;
+        radius = lineLength / 2.0;
+      }
+      if (this->ShapeName == Sphere)
+      {
+        return true;
+      }
+      this->GetNthControlPointPositionWorld(2, p3);
+      break;
+    }
+    case Disk :
+    {
+      double closestPoint[3] = { 0.0 }; // Unused here
+      double farthestPoint[3] = { 0.0 };
+      if (!this->DescribeDiskPointSpacing(closestPoint, farthestPoint, innerRadius, radius))
+      {
+        return false;
+      }
+      this->GetNthControlPointPositionWorld(0, center);
+      this->GetNthControlPointPositionWorld(1, p2);
+      this->GetNthControlPointPositionWorld(2, p3);
+      break;
+    }
+    default :
+      return false;
+  };
+  
+  // Relative to center
+  const double rp2[3] = { p2[0] - center[0], p2[1] - center[1], p2[2] - center[2] };
+  const double rp3[3] = { p3[0] - center[0], p3[1] - center[1], p3[2] - center[2] };
+  vtkMath::Cross(rp2, rp3, normal);
+  if (normal[0] == 0.0 && normal[1] == 0.0 && normal[2] == 0.0)
+  {
+    vtkDebugMacro("Got zero normal.");
+    return false;
+  }
+  return true;
+}
+
+//---------------------------- Disk ------------------------------------------
+bool vtkMRMLMarkupsShapeNode::UpdateDiskWorld(vtkPolyData * shapeWorld, double resolution)
+{
+  double center[3] = { 0.0 };
+  double normal[3] = { 0.0 };
+  double innerRadius = 0.0, outerRadius = 0.0;
+  if (!this->DescribeShapeWorld(center, normal, outerRadius, innerRadius))
+  {
+    return false;
+  }
+  this->DiskSource->SetCenter(center);
+  this->DiskSource->SetNormal(normal);
+  this->DiskSource->SetInnerRadius(innerRadius);
+  this->DiskSource->SetOuterRadius(outerRadius);
+  this->DiskSource->SetCircumferentialResolution((int) resolution);
+  this->DiskSource->SetOutputPointsPrecision(this->OutputPointsPrecision);
+  this->DiskSource->Update();
+  shapeWorld->ShallowCopy(this->DiskSource->GetOutput());
+  return true;
+}
+
+//---------------------------- Ring ------------------------------------------
+bool vtkMRMLMarkupsShapeNode::UpdateRingWorld(vtkPolyData * shapeWorld, double resolution)
+{
+  double center[3] = { 0.0 };
+  double normal[3] = { 0.0 };
+  double radius = 0.0, innerRadius = 0.0;
+  if (!this->DescribeShapeWorld(center, normal, radius, innerRadius))
+  {
+    return false;
+  }
+  this->RingSource->SetCenter(center);
+  this->RingSource->SetNormal(normal);
+  this->RingSource->SetRadius(radius);
+  this->RingSource->SetNumberOfSides((int) resolution);
+  this->RingSource->SetOutputPointsPrecision(this->OutputPointsPrecision);
+  this->RingSource->Update();
+  shapeWorld->ShallowCopy(this->RingSource->GetOutput());
+  return true;
+}
+
+//---------------------------- Sphere ------------------------------------------
+bool vtkMRMLMarkupsShapeNode::UpdateSphereWorld(vtkPolyData * shapeWorld, double resolution)
+{
+  double center[3] = { 0.0 };
+  double normal[3] = { 0.0 }; // Unused here
+  double radius = 0.0, innerRadius = 0.0;
+  if (!this->DescribeShapeWorld(center, normal, radius, innerRadius))
+  {
+    return false;
+  }
+  this->SphereSource->SetCenter(center);
+  this->SphereSource->SetRadius(radius);
+  this->SphereSource->SetPhiResolution(resolution);
+  this->SphereSource->SetThetaResolution(resolution);
+  this->SphereSource->SetOutputPointsPrecision(this->OutputPointsPrecision);
+  this->SphereSource->Update();
+  shapeWorld->ShallowCopy(this->SphereSource->GetOutput());
+  return true;
+}
+
+//---------------------------- Sphere set ------------------------------------
+bool vtkMRMLMarkupsShapeNode::UpdateSphereSetWorld(vtkPolyData * shapeWorld)
+{
+  // Does not depend on resolution : views scale a sphere glyph by SphereRadius.
+  vtkNew<vtkPoints> centers;
+  if (this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+  {
+    centers->SetDataTypeToDouble();
+  }
+  vtkNew<vtkDoubleArray> radii;
+  radii->SetName("SphereRadius");
+  vtkNew<vtkCellArray> vertices;
+  double center[3] = { 0.0 };
+  double radius = 0.0;
+  for (int i = 0; i < this->GetNumberOfControlPoints(); i = i + 2)
+  {
+    if (this->DescribeSphereAtControlPointPair(i, center, radius))
+    {
+      vertices->InsertNextCell(1);
+      vertices->InsertCellPoint(centers->InsertNextPoint(center));
+      radii->InsertNextValue(radius);
+    }
+  }
+  if (centers->GetNumberOfPoints() == 0)
+  {
+    return false;
+  }
+  shapeWorld->Initialize();
+  shapeWorld->SetPoints(centers);
+  shapeWorld->SetVerts(vertices);
+  shapeWorld->GetPointData()->AddArray(radii);
+  return true;
+}
+
+//---------------------------- Tube ------------------------------------------
+bool vtkMRMLMarkupsShapeNode::UpdateTubeWorld(vtkPolyData * shapeWorld, double resolution)
+{
+  if (!this->UpdateTubeCenterline())
+  {
+    return false;
+  }
+  if (this->TubeSamplingMode == SegmentSampling)
+  {
+    // Shares the arrays patched in place.
+    vtkShapeTimingCounters::ScopedTimer timer("TubeSweep", this->ShapeName);
+    shapeWorld->ShallowCopy(this->SegmentedTube->UpdateSurface((int) resolution));
+    return true;
+  }
+  this->Tube->SetNumberOfSides((int) resolution);
+  {
+    vtkShapeTimingCounters::ScopedTimer timer("TubeSweep", this->ShapeName);
+    this->Tube->Update();
+  }
+  shapeWorld->ShallowCopy(this->Tube->GetOutput());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::CompactShapeWorld(vtkPolyData * shapeWorld)
+{
+  // A sphere set is a point per sphere, a ring or a disk has few cells.
+  if (this->ShapeName == Tube || (this->ShapeName == Sphere && !this->SphereSet))
+  {
+    if (this->OutputTopology == StripTopology && shapeWorld->GetNumberOfPolys() > 0)
+    {
+      vtkNew<vtkStripper> stripper;
+      stripper->SetInputData(shapeWorld);
+      stripper->Update();
+      shapeWorld->ShallowCopy(stripper->GetOutput());
+    }
+    else if (this->OutputTopology == TriangleTopology && shapeWorld->GetNumberOfStrips() > 0)
+    {
+      vtkNew<vtkTriangleFilter> triangleFilter;
+      triangleFilter->SetInputData(shapeWorld);
+      triangleFilter->Update();
+      shapeWorld->ShallowCopy(triangleFilter->GetOutput());
+    }
+    vtkDataArray * normals = shapeWorld->GetPointData()->GetNormals();
+    if (!this->OutputNormals && normals)
+    {
+      // The point data is not shared with the source, only the arrays are.
+      shapeWorld->GetPointData()->RemoveArray(normals->GetName());
+    }
+  }
+  // Half the memory of vtkIdType indices. The cells are shared with the source outputs
+  // and the segmented tube surfaces : they are appended to new 32 bit arrays, not converted.
+  auto compactCells = [](vtkCellArray * cells) -> vtkSmartPointer<vtkCellArray>
+  {
+    if (!cells || !cells->IsStorage64Bit() || !cells->CanConvertTo32BitStorage())
+    {
+      return cells;
+    }
+    vtkSmartPointer<vtkCellArray> compact = vtkSmartPointer<vtkCellArray>::New();
+    compact->Use32BitStorage();
+    compact->Append(cells);
+    return compact;
+  };
+  shapeWorld->SetVerts(compactCells(shapeWorld->GetVerts()));
+  shapeWorld->SetLines(compactCells(shapeWorld->GetLines()));
+  shapeWorld->SetPolys(compactCells(shapeWorld->GetPolys()));
+  shapeWorld->SetStrips(compactCells(shapeWorld->GetStrips()));
+}
+
+//----------------------------------------------------------------------------
+vtkPolyData * vtkMRMLMarkupsShapeNode::UpdateTubeCenterline()
+{
+  if (this->GetNumberOfControlPoints() < 4
+    || this->GetNumberOfUndefinedControlPoints() > 0
+    || (this->GetNumberOfControlPoints() % 2) != 0) // Complete point pairs required.
+  {
+    return nullptr;
+  }
+  
+  // Less centerline samples in preview, in the same proportion as the sides.
+  // The centerline does not depend on the number of sides, views share it.
+  const double samplingFactor = this->GetGeometryResolution() / std::max(this->Resolution, 1.0);
+  vtkPolyData * centerline = nullptr;
+  switch (this->TubeSamplingMode)
+  {
+    case AdaptiveSampling :
+      centerline = this->TubeCenterline;
+      break;
+    case SegmentSampling :
+      centerline = this->SegmentedTube->GetCenterline();
+      break;
+    default :
+      centerline = this->SplineFunctionSource->GetOutput();
+      break;
+  };
+  if (!this->IsOutdated(this->TubeCenterlineBuildTime, this->TubeCenterlineNumberOfControlPoints)
+    && this->TubeCenterlineSamplingFactor == samplingFactor)
+  {
+    return centerline;
+  }
+  this->TubeCenterlineBuildTime.Modified();
+  this->TubeCenterlineNumberOfControlPoints = this->GetNumberOfDefinedControlPoints(true);
+  this->TubeCenterlineSamplingFactor = samplingFactor;
+  
+  // Persistent buffers, resized in place : steady state updates do not allocate.
+  const int numberOfKnots = this->GetNumberOfControlPoints() / 2;
+  this->TubeSplinePoints->SetNumberOfPoints(numberOfKnots);
+  this->TubeKnotRadii.resize(numberOfKnots);
+  this->TubeKnotParameters.resize(numberOfKnots);
+  for (int i = 0; i < numberOfKnots; i++)
+  {
+    double p1[3] = { 0.0 };
+    double p2[3] = { 0.0 };
+    this->GetNthControlPointPositionWorld(2 * i, p1);
+    this->GetNthControlPointPositionWorld(2 * i + 1, p2);
+    this->TubeSplinePoints->SetPoint(i, (p1[0] + p2[0]) / 2.0,
+                                        (p1[1] + p2[1]) / 2.0,
+                                        (p1[2] + p2[2]) / 2.0);
+    this->TubeKnotRadii[i] = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2)) / 2.0;
+  }
+  this->TubeSplinePoints->Modified();
+  // The spline is parameterized by length : knots are at cumulative chord length fractions.
+  double length = 0.0;
+  for (int i = 0; i < numberOfKnots; i++)
+  {
+    if (i > 0)
+    {
+      double previous[3] = { 0.0 };
+      double current[3] = { 0.0 };
+      this->TubeSplinePoints->GetPoint(i - 1, previous);
+      this->TubeSplinePoints->GetPoint(i, current);
+      length += std::sqrt(vtkMath::Distance2BetweenPoints(previous, current));
+    }
+    this->TubeKnotParameters[i] = length;
+  }
+  for (int i = 0; i < numberOfKnots; i++)
+  {
+    this->TubeKnotParameters[i] = (length > 0.0) ? this->TubeKnotParameters[i] / length
+                                                 : (double) i / (double) (numberOfKnots - 1);
+  }
+  if (this->TubeSamplingMode == SegmentSampling)
+  {
+    // Only segments next to the pairs that moved are resampled.
+    const int samplesPerPair = std::max(2, (int) (100.0 * samplingFactor));
+    this->SegmentedTube->SetKnots(this->TubeSplinePoints, this->TubeKnotRadii, samplesPerPair);
+    return centerline;
+  }
+  // Same points object : SetPoints() alone would not modify the spline.
+  this->Spline->SetPoints(this->TubeSplinePoints);
+  this->Spline->Modified();
+  
+  if (this->TubeSamplingMode == AdaptiveSampling)
+  {
+    this->SampleTubeCenterlineAdaptively(this->TubeMaximumChordError / samplingFactor);
+    this->Tube->SetInputData(this->TubeCenterline);
+  }
+  else
+  {
+    const int samplesPerPair = std::max(2, (int) (100.0 * samplingFactor));
+    this->SplineFunctionSource->SetUResolution(samplesPerPair * numberOfKnots);
+    this->SplineFunctionSource->SetVResolution(samplesPerPair * numberOfKnots);
+    this->SplineFunctionSource->SetWResolution(samplesPerPair * numberOfKnots);
+    this->SplineFunctionSource->Update();
+    vtkPolyData * splinePolyData = this->SplineFunctionSource->GetOutput();
+    const vtkIdType numberOfSamples = splinePolyData->GetNumberOfPoints();
+    
+    // https://kitware.github.io/vtk-examples/site/Cxx/VisualizationAlgorithms/TubesFromSplines/
+    this->TubeRadius->SetNumberOfTuples(numberOfSamples);
+    double * tubeRadius = this->TubeRadius->GetPointer(0);
+    const double step = (numberOfSamples > 1) ? 1.0 / (numberOfSamples - 1) : 0.0;
+    for (vtkIdType i = 0; i < numberOfSamples; ++i)
+    {
+      tubeRadius[i] = this->InterpolateTubeRadius(step * i);
+    }
+    this->TubeRadius->Modified();
+    
+    // The source output is regenerated on update, without the radius array.
+    splinePolyData->GetPointData()->AddArray(this->TubeRadius);
+    splinePolyData->GetPointData()->SetActiveScalars("TubeRadius");
+    this->Tube->SetInputConnection(this->SplineFunctionSource->GetOutputPort());
+    centerline = splinePolyData;
+  }
+  return centerline;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::SetTubeProfile(vtkDoubleArray * centerline, vtkDoubleArray * radii)
+{
+  if (!centerline || centerline->GetNumberOfComponents() != 3)
+  {
+    vtkErrorMacro("Centerline points with 3 components are required.");
+    return false;
+  }
+  // The points share the array, nothing is copied.
+  vtkNew<vtkPoints> points;
+  points->SetData(centerline);
+  return this->SetTubeProfile(points, radii);
+}
+
+//----------------------------------------------------------------------------
+vtkDoubleArray * vtkMRMLMarkupsShapeNode::GetTubeCenterlinePoints()
+{
+  this->UpdateTubeCenterlineArrays();
+  return this->TubeCenterlinePoints;
+}
+
+//----------------------------------------------------------------------------
+vtkDoubleArray * vtkMRMLMarkupsShapeNode::GetTubeCenterlineRadii()
+{
+  this->UpdateTubeCenterlineArrays();
+  return this->TubeCenterlineRadii;
+}
+
+//----------------------------------------------------------------------------
+vtkDoubleArray * vtkMRMLMarkupsShapeNode::GetTubeCenterlineArcLength()
+{
+  this->UpdateTubeCenterlineArrays();
+  return this->TubeCenterlineArcLength;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::UpdateTubeCenterlineArrays()
+{
+  vtkPolyData * centerline = (this->GetShapeName() == Tube) ? this->UpdateTubeCenterline() : nullptr;
+  vtkDataArray * radii = centerline ? centerline->GetPointData()->GetArray("TubeRadius") : nullptr;
+  if (!centerline || !centerline->GetPoints() || !radii)
+  {
+    if (this->TubeCenterlineArraysSource || this->TubeCenterlinePoints->GetNumberOfTuples() > 0)
+    {
+      this->TubeCenterlinePoints->SetNumberOfTuples(0);
+      this->TubeCenterlineRadii->SetNumberOfTuples(0);
+      this->TubeCenterlineArcLength->SetNumberOfTuples(0);
+      this->TubeCenterlinePoints->Modified();
+      this->TubeCenterlineRadii->Modified();
+      this->TubeCenterlineArcLength->Modified();
+    }
+    this->TubeCenterlineArraysSource = nullptr;
+    this->TubeCenterlineArraysVersion = 0;
+    return;
+  }
+  // The sampling mode selects the centerline object; each is modified when resampled.
+  const vtkMTimeType version = std::max(centerline->GetMTime(), this->TubeCenterlineBuildTime.GetMTime());
+  if (centerline == this->TubeCenterlineArraysSource && version == this->TubeCenterlineArraysVersion)
+  {
+    return;
+  }
+  this->TubeCenterlineArraysSource = centerline;
+  this->TubeCenterlineArraysVersion = version;
+  
+  vtkPoints * points = centerline->GetPoints();
+  const vtkIdType numberOfSamples = points->GetNumberOfPoints();
+  // Same size : the existing buffers are overwritten.
+  this->TubeCenterlinePoints->SetNumberOfTuples(numberOfSamples);
+  this->TubeCenterlineRadii->SetNumberOfTuples(numberOfSamples);
+  this->TubeCenterlineArcLength->SetNumberOfTuples(numberOfSamples);
+  double * pointValues = this->TubeCenterlinePoints->GetPointer(0);
+  double * radiusValues = this->TubeCenterlineRadii->GetPointer(0);
+  double * arcLengthValues = this->TubeCenterlineArcLength->GetPointer(0);
+  double arcLength = 0.0;
+  for (vtkIdType i = 0; i < numberOfSamples; i++)
+  {
+    double * point = pointValues + 3 * i;
+    points->GetPoint(i, point);
+    radiusValues[i] = radii->GetTuple1(i);
+    if (i > 0)
+    {
+      arcLength += std::sqrt(vtkMath::Distance2BetweenPoints(point - 3, point));
+    }
+    arcLengthValues[i] = arcLength;
+  }
+  this->TubeCenterlinePoints->Modified();
+  this->TubeCenterlineRadii->Modified();
+  this->TubeCenterlineArcLength->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLMarkupsShapeNode::IntegrateTubeCenterline(double& lateralArea, double& volume)
+{
+  lateralArea = 0.0;
+  volume = 0.0;
+  vtkPolyData * centerline = this->UpdateTubeCenterline();
+  if (!centerline || centerline->GetNumberOfPoints() < 2)
+  {
+    return false;
+  }
+  vtkPoints * points = centerline->GetPoints();
+  vtkDataArray * radii = centerline->GetPointData()->GetArray("TubeRadius");
+  if (!radii)
+  {
+    return false;
+  }
+  // Sum of the frustums between consecutive samples.
+  double p1[3] = { 0.0 };
+  points->GetPoint(0, p1);
+  double r1 = radii->GetTuple1(0);
+  for (vtkIdType i = 1; i < points->GetNumberOfPoints(); i++)
+  {
+    double p2[3] = { 0.0 };
+    points->GetPoint(i, p2);
+    const double r2 = radii->GetTuple1(i);
+    const double height = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
+    const double slantHeight = std::sqrt(height * height + (r2 - r1) * (r2 - r1));
+    lateralArea += vtkMath::Pi() * (r1 + r2) * slantHeight;
+    volume += vtkMath::Pi() * height * (r1 * r1 + r1 * r2 + r2 * r2) / 3.0;
+    p1[0] = p2[0];
+    p1[1] = p2[1];
+    p1[2] = p2[2];
+    r1 = r2;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLMarkupsShapeNode::InterpolateTubeRadius(double u)
+{
+  // Linear between knots, at the knot parameters of the spline.
+  const std::vector<double>& knots = this->TubeKnotParameters;
+  const int lastKnot = (int) knots.size() - 1;
+  if (lastKnot <= 0 || lastKnot + 1 != (int) this->TubeKnotRadii.size())
+  {
+    return (lastKnot == 0 && !this->TubeKnotRadii.empty()) ? this->TubeKnotRadii[0] : 0.0;
+  }
+  const double t = std::min(std::max(u, 0.0), 1.0);
+  // Last knot whose parameter is not above t, the span end excluded.
+  const int knot = std::max(0, std::min((int) (std::upper_bound(knots.begin(), knots.end(), t) - knots.begin()) - 1,
+                                        lastKnot - 1));
+  const double span = knots[knot + 1] - knots[knot];
+  const double fraction = (span > 0.0) ? (t - knots[knot]) / span : 0.0;
+  return this->TubeKnotRadii[knot] + fraction * (this->TubeKnotRadii[knot + 1] - this->TubeKnotRadii[knot]);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SampleTubeCenterlineAdaptively(double maximumChordError)
+{
+  /*
+   * The spline is parameterized by length : its knots are at the cumulative chord length
+   * fractions in TubeKnotParameters. The radius is interpolated linearly in u between control
+   * point pairs, as in uniform sampling; sub spans start at the knots, so that each pair's
+   * radius is sampled at its middle point.
+   */
+  vtkPoints * samples = this->TubeSamples;
+  vtkDoubleArray * parameters = this->TubeSampleParameters;
+  samples->Reset();
+  parameters->Reset();
+  const std::vector<double>& knots = this->TubeKnotParameters;
+  const int numberOfKnots = (int) knots.size();
+  // Splitting each span avoids missing S-shaped spans whose middle lies on the chord.
+  const int numberOfSubSpans = 4;
+  const int numberOfIntervals = (numberOfKnots - 1) * numberOfSubSpans;
+  
+  double u1[3] = { 0.0 };
+  double p1[3] = { 0.0 };
+  double du[9] = { 0.0 };
+  this->Spline->Evaluate(u1, p1, du);
+  samples->InsertNextPoint(p1);
+  parameters->InsertNextValue(u1[0]);
+  for (int i = 1; i <= numberOfIntervals; i++)
+  {
+    const int knot = (i - 1) / numberOfSubSpans;
+    const int subSpan = i - knot * numberOfSubSpans;
+    double u2[3] = { knots[knot] + (knots[knot + 1] - knots[knot]) * subSpan / numberOfSubSpans, 0.0, 0.0 };
+    if (u2[0] <= u1[0])
+    {
+      // Coincident pair middles.
+      continue;
+    }
+    double p2[3] = { 0.0 };
+    this->Spline->Evaluate(u2, p2, du);
+    this->SampleTubeSpan(u1[0], p1, u2[0], p2, maximumChordError, samples, parameters, 0);
+    u1[0] = u2[0];
+    p1[0] = p2[0];
+    p1[1] = p2[1];
+    p1[2] = p2[2];
+  }
+  
+  const vtkIdType numberOfSamples = samples->GetNumberOfPoints();
+  this->TubeCenterlineRadius->SetNumberOfTuples(numberOfSamples);
+  double * tubeRadius = this->TubeCenterlineRadius->GetPointer(0);
+  const double * parameterValues = parameters->GetPointer(0);
+  vtkCellArray * lines = this->TubeCenterline->GetLines();
+  lines->Reset();
+  lines->InsertNextCell(numberOfSamples);
+  for (vtkIdType i = 0; i < numberOfSamples; i++)
+  {
+    tubeRadius[i] = this->InterpolateTubeRadius(parameterValues[i]);
+    lines->InsertCellPoint(i);
+  }
+  
+  // Points, lines and radius array are set once in the constructor.
+  samples->Modified();
+  lines->Modified();
+  this->TubeCenterlineRadius->Modified();
+  this->TubeCenterline->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLMarkupsShapeNode::SampleTubeSpan(double u1, const double * p1, double u2, const double * p2,
+                                             double maximumChordError,
+                                             vtkPoints * samples, vtkDoubleArray * parameters, int depth)
+{
+  // p1 is already sampled; append points up to p2 included.
+  double um[3] = { (u1 + u2) / 2.0, 0.0, 0.0 };
+  double pm[3] = { 0.0 };
+  double du[9] = { 0.0 };
+  this->Spline->Evaluate(um, pm, du);
+  const double chordMiddle[3] = { (p1[0] + p2[0]) / 2.0,
+                                  (p1[1] + p2[1]) / 2.0,
+                                  (p1[2] + p2[2]) / 2.0 };
+  const double chordError = std::sqrt(vtkMath::Distance2BetweenPoints(pm, chordMiddle));
+  // Bounds recursion on degenerate input, 2^10 samples per sub span at most.
+  const int maximumDepth = 10;
+  if (chordError > maximumChordError && depth < maximumDepth)
+  {
+    this->SampleTubeSpan(u1, p1, um[0], pm, maximumChordError, samples, parameters, depth + 1);
+    this->SampleTubeSpan(um[0], pm, u2, p2, maximumChordError, samples, parameters, depth + 1);
+    return;
+  }
+  samples->InsertNextPoint(p2);
+  parameters->InsertNextValue(u2);
+}
@@ -22,9 +22,25 @@
 #define __vtkmrmlmarkupsShape_LOWERnode_h_
 
 #include <vtkMRMLMarkupsNode.h>
+#include <vtkAlgorithm.h>
 
 #include "vtkSlicerShapeModuleMRMLExport.h"
 
+#include <future>
+#include <map>
+#include <memory>
+#include <vector>
+
+class vtkDiskSource;
+class vtkDoubleArray;
+class vtkParametricFunctionSource;
+class vtkParametricSpline;
+class vtkRegularPolygonSource;
+class vtkShapeSegmentedTube;
+class vtkShapeTubeSweep;
+class vtkSphereSource;
+class vtkTrivialProducer;
+
 //-----------------------------------------------------------------------------
 class VTK_SLICER_SHAPE_MODULE_MRML_EXPORT vtkMRMLMarkupsShapeNode
 : public vtkMRMLMarkupsNode
@@ -47,6 +63,35 @@ public:
     Intersection = 0,
     Projection
   };
+  enum
+  {
+    UniformSampling = 0,
+    AdaptiveSampling,
+    SegmentSampling
+  };
+  enum
+  {
+    FixedResolution = 0,
+    AutomaticResolution
+  };
+  enum
+  {
+    NativeTopology = 0,
+    StripTopology,
+    TriangleTopology
+  };
+  enum
+  {
+    RadiusMeasurement = 0,
+    InnerRadiusMeasurement,
+    OuterRadiusMeasurement,
+    WidthMeasurement,
+    AreaMeasurement,
+    InnerAreaMeasurement,
+    OuterAreaMeasurement,
+    VolumeMeasurement,
+    Measurement_Last
+  };
   static vtkMRMLMarkupsShapeNode* New();
   vtkTypeMacro(vtkMRMLMarkupsShapeNode, vtkMRMLMarkupsNode);
   void PrintSelf(ostream& os, vtkIndent indent) override;
@@ -75,19 +120,84 @@ public:
   /// \sa vtkMRMLNode::CopyContent
   vtkMRMLCopyContentDefaultMacro(vtkMRMLMarkupsShapeNode);
   
+  /// Create a vtkMRMLMarkupsShapeDisplayNode.
+  void CreateDefaultDisplayNodes() override;
+  
   vtkGetMacro(ShapeName, int);
   void SetShapeName(int shapeName);
+  /// "Sphere", "Ring", "Disk" or "Tube"; "Unknown" for other values.
+  static const char * GetShapeNameAsString(int shapeName);
+  /// Sphere shape only : the node holds any number of spheres, one per control point pair,
+  /// following RadiusMode. They are rendered at once in 3D views, by a single glyph mapper.
+  void SetSphereSet(bool sphereSet);
+  vtkGetMacro(SphereSet, bool);
+  vtkBooleanMacro(SphereSet, bool);
   
-  vtkSetMacro(RadiusMode, int);
+  void SetRadiusMode(int mode);
   vtkGetMacro(RadiusMode, int);
   vtkSetMacro(DrawMode2D, int);
   vtkGetMacro(DrawMode2D, int);
-  vtkSetMacro(Resolution, double);
+  void SetResolution(double resolution);
   vtkGetMacro(Resolution, double);
+  /// Resolution of the generated geometry. It is the display node's PreviewResolution
+  /// while a control point is dragged, if it is lower than Resolution.
+  double GetGeometryResolution();
+  /// Whether a control point is being dragged.
+  vtkGetMacro(InteractionInProgress, bool);
+  /// FixedResolution : all views use GetGeometryResolution().
+  /// AutomaticResolution : each view uses a resolution depending on the shape size on screen,
+  /// at most GetGeometryResolution().
+  void SetResolutionMode(int mode);
+  vtkGetMacro(ResolutionMode, int);
+  /// Resolution suited to a view with the given scale factor, to use with the
+  /// resolution specific methods below.
+  int GetViewResolution(double viewScaleFactorMmPerPixel);
+  
+  /// Tube centerline sampling.
+  /// UniformSampling : 100 samples per control point pair.
+  /// AdaptiveSampling : samples are added where the centerline bends, until the
+  /// distance between the spline and its chords is below TubeMaximumChordError.
+  /// SegmentSampling : 100 samples per control point pair on a local spline; when pairs
+  /// move, only the neighbouring segments are resampled and swept again. For long tubes.
+  void SetTubeSamplingMode(int mode);
+  vtkGetMacro(TubeSamplingMode, int);
+  /// Maximum distance in mm between the centerline spline and the sampled polyline.
+  void SetTubeMaximumChordError(double error);
+  vtkGetMacro(TubeMaximumChordError, double);
+  
+  /// Mesh output, for many shapes at high resolution.
+  /// Precision of Sphere, Ring and Disk points : vtkAlgorithm::SINGLE_PRECISION (default)
+  /// or vtkAlgorithm::DOUBLE_PRECISION. Tube points are always single precision.
+  void SetOutputPointsPrecision(int precision);
+  vtkGetMacro(OutputPointsPrecision, int);
+  /// Sphere and Tube cells. NativeTopology : triangles for Sphere, strips for Tube.
+  /// StripTopology : Sphere triangles are joined in strips.
+  /// TriangleTopology : Tube strips are split in indexed triangles.
+  void SetOutputTopology(int topology);
+  vtkGetMacro(OutputTopology, int);
+  /// Sphere and Tube point normals, for smooth shading in 3D views.
+  /// Slice views do not use them; without them, 3D views shade each cell flat.
+  void SetOutputNormals(bool enabled);
+  vtkGetMacro(OutputNormals, bool);
+  vtkBooleanMacro(OutputNormals, bool);
   
-  vtkPolyData * GetShapeWorld() const {return this->ShapeWorld;}
-  // Used by 3D representation.
-  void SetShapeWorld(vtkPolyData * polydata) {this->ShapeWorld = polydata;}
+  /// Shape geometry in world coordinates, shared by all views and measurements.
+  /// It is regenerated on demand if control points or shape parameters changed,
+  /// other node modifications like selection, display or measurements do not rebuild it.
+  /// It is generated at GetGeometryResolution().
+  /// For a sphere set, it holds the sphere centers, with a SphereRadius point array.
+  vtkPolyData * GetShapeWorld();
+  vtkPolyData * GetShapeWorld(int resolution);
+  /// Same geometry as GetShapeWorld(), as a pipeline input for filters and mappers.
+  /// Call UpdateShapeWorld() before updating the consumers.
+  vtkAlgorithmOutput * GetShapeWorldConnection();
+  vtkAlgorithmOutput * GetShapeWorldConnection(int resolution);
+  /// Regenerate the shape geometry if it is out of date.
+  void UpdateShapeWorld();
+  void UpdateShapeWorld(int resolution);
+  /// Changes each time the shape geometry is regenerated.
+  vtkMTimeType GetShapeWorldVersion();
+  vtkMTimeType GetShapeWorldVersion(int resolution);
   
   vtkSetObjectMacro(ResliceNode, vtkMRMLNode);
   vtkGetObjectMacro(ResliceNode, vtkMRMLNode);
@@ -99,9 +209,81 @@ public:
   void SetOuterRadius(double radius);
   bool DescribeDiskPointSpacing(double * closestPoint, double * farthestPoint,
                                double& innerRadius, double& outerRadius);
+  /// Analytic description of Sphere, Ring and Disk in world coordinates.
+  /// normal is not normalized, and is null for Sphere. innerRadius is 0 except for Disk.
+  /// Returns false for a sphere set, see DescribeNthSphere().
+  bool DescribeShapeWorld(double * center, double * normal,
+                          double& radius, double& innerRadius);
+  /// A sphere enclosing the shape geometry in world coordinates, to reject views
+  /// and slices the shape does not reach. It is evaluated again only if the shape changed.
+  /// Returns false if the shape is not defined.
+  bool GetShapeWorldBoundingSphere(double * center, double& radius);
+  /// Value of a measurement of the current shape, one of RadiusMeasurement...
+  /// All values are evaluated at once, and again only if the shape changed.
+  /// Returns false if the shape is not defined or does not have this measurement.
+  bool GetMeasurementValue(int measurement, double& value);
+  /// Tube area and volume are integrated along the centerline by default,
+  /// they do not depend on Resolution. If enabled, they are measured
+  /// on the tube mesh instead, and compared in debug output.
+  void SetTubeMeshMeasurements(bool enabled);
+  vtkGetMacro(TubeMeshMeasurements, bool);
+  vtkBooleanMacro(TubeMeshMeasurements, bool);
+  /// Tube mesh measurements are evaluated on a copy of the mesh in a worker thread
+  /// if enabled, instead of blocking the caller. Area and volume keep their previous
+  /// values and are pending until ProcessAsynchronousMeasurements() publishes the result.
+  /// Off by default.
+  void SetAsynchronousMeasurements(bool enabled);
+  vtkGetMacro(AsynchronousMeasurements, bool);
+  vtkBooleanMacro(AsynchronousMeasurements, bool);
+  /// True if the measurement waits for a worker thread.
+  bool IsMeasurementPending(int measurement);
+  /// To call in the main thread. Publishes a finished evaluation and updates all measurements.
+  /// A result of a geometry that has changed since is dropped.
+  /// Returns true if measurements were updated.
+  bool ProcessAsynchronousMeasurements();
+  /// Drop the pending evaluation and wait until no worker of this node runs.
+  /// Called on destruction; measurements are evaluated again on the next update.
+  void CancelAsynchronousMeasurements();
+  /// To call in the main thread. Block until the workers of this node have finished,
+  /// then publish the pending evaluation.
+  /// Returns true if measurements were updated.
+  bool WaitForAsynchronousMeasurements();
+#ifndef __VTK_WRAP__
+  /// Called in a worker thread each time an evaluation of this node has finished ;
+  /// ProcessAsynchronousMeasurements() must then be called in the main thread.
+  /// Once reset, the previous callback is no longer called.
+  typedef void (*MeasurementsReadyCallbackType)(void * clientData);
+  void SetMeasurementsReadyCallback(MeasurementsReadyCallbackType callback, void * clientData);
+#endif
   // For Tube shape;
   double GetRadiusAtNthControlPoint(int n);
   void SetRadiusAtNthControlPoint(int n, double radius);
+  /// Tube : set the radius of all control point pairs at once, one tuple per pair.
+  /// Each pair keeps its middle point and direction. Views and measurements are updated once.
+  bool SetTubeRadii(vtkDoubleArray * radii);
+  /// Tube : replace all control points by one pair per centerline point, with the given radius.
+  /// Pairs are placed across the centerline, with a direction rotating as little as possible.
+  /// Views and measurements are updated once.
+  bool SetTubeProfile(vtkPoints * centerline, vtkDoubleArray * radii);
+  /// Tube : as above, with centerline points as a 3 component array, e.g. from numpy_to_vtk().
+  bool SetTubeProfile(vtkDoubleArray * centerline, vtkDoubleArray * radii);
+  /// Tube : centerline samples used for the mesh and measurements, 3 components;
+  /// radius and cumulative arc length at each sample. Empty if the tube is not defined.
+  /// The arrays are owned by the node and updated in place when the shape changes,
+  /// vtk.util.numpy_support.vtk_to_numpy() views remain valid while the number of samples is the same.
+  vtkDoubleArray * GetTubeCenterlinePoints();
+  vtkDoubleArray * GetTubeCenterlineRadii();
+  vtkDoubleArray * GetTubeCenterlineArcLength();
+  
+  /// Sphere set : number of spheres with both control points defined.
+  int GetNumberOfSpheres();
+  /// Sphere set : the nth sphere with both control points defined.
+  bool DescribeNthSphere(int n, double * center, double& radius);
+  /// Sphere set : RadiusMeasurement, AreaMeasurement or VolumeMeasurement of the nth sphere.
+  /// GetMeasurementValue() reports the total area and volume of the set.
+  bool GetNthSphereMeasurementValue(int n, int measurement, double& value);
+  /// Sphere set : the sphere containing the position or with the closest surface, -1 if none.
+  int GetSphereIndexAtPositionWorld(const double * position);
 
 protected:
   vtkMRMLMarkupsShapeNode();
@@ -118,21 +300,135 @@ protected:
   void ForceSphereMeasurements();
   void ForceTubeMeasurements();
   
+  // Shape geometry generation, each returns false if the shape is not defined.
+  bool UpdateDiskWorld(vtkPolyData * shapeWorld, double resolution);
+  bool UpdateRingWorld(vtkPolyData * shapeWorld, double resolution);
+  bool UpdateSphereWorld(vtkPolyData * shapeWorld, double resolution);
+  bool UpdateSphereSetWorld(vtkPolyData * shapeWorld);
+  bool UpdateTubeWorld(vtkPolyData * shapeWorld, double resolution);
+  // Apply OutputTopology and OutputNormals, and store cells with 32 bit indices if possible.
+  void CompactShapeWorld(vtkPolyData * shapeWorld);
+  // Sampled centerline with a TubeRadius point array, nullptr if the tube is not defined.
+  vtkPolyData * UpdateTubeCenterline();
+  // Lateral area and volume of the frustums between centerline samples.
+  bool IntegrateTubeCenterline(double& lateralArea, double& volume);
+  // Whether something built at buildTime is older than the inputs that define the shape.
+  bool IsOutdated(const vtkTimeStamp& buildTime, int numberOfDefinedControlPoints);
+  // Tube and sphere set : control points go by pairs.
+  bool HasControlPointPairs();
+  // Sphere set : the sphere of the pair starting at firstIndex, false if a point is not defined.
+  bool DescribeSphereAtControlPointPair(int firstIndex, double * center, double& radius);
+  bool ComputeShapeWorldBoundingSphere(double * center, double& radius);
+  // Radius for Sphere, Ring and Disk, largest radius for Tube and sphere set.
+  double GetMaximumShapeRadius();
+  // Evaluate all measurements of the current shape if it changed.
+  void UpdateMeasurementValues();
+  // Copy the current centerline to the persistent arrays if it changed.
+  void UpdateTubeCenterlineArrays();
+  // Fill TubeCenterline with adaptive samples of Spline and their radius.
+  void SampleTubeCenterlineAdaptively(double maximumChordError);
+  // Radius at spline parameter u, linear between TubeKnotRadii at TubeKnotParameters.
+  double InterpolateTubeRadius(double u);
+  void SampleTubeSpan(double u1, const double * p1, double u2, const double * p2,
+                      double maximumChordError,
+                      vtkPoints * samples, vtkDoubleArray * parameters, int depth);
+  
   // Tube
   vtkSmartPointer<vtkCallbackCommand> OnPointPositionUndefinedCallback;
   static void OnPointPositionUndefined(vtkObject *caller,
                                        unsigned long event, void *clientData, void *callData);
+  // Ring : keep p3 on the circle when any control point moves.
+  vtkSmartPointer<vtkCallbackCommand> OnPointModifiedCallback;
+  static void OnPointModified(vtkObject *caller,
+                              unsigned long event, void *clientData, void *callData);
+  // Ring : move p3 to its exact projection on the circle, if it is not there.
+  void SnapRingThirdPoint();
+  // Preview resolution during control point drag.
+  vtkSmartPointer<vtkCallbackCommand> OnInteractionCallback;
+  static void OnInteraction(vtkObject *caller,
+                            unsigned long event, void *clientData, void *callData);
+  bool InteractionInProgress { false };
 
   int ShapeName { Sphere };
+  bool SphereSet { false };
   int RadiusMode { Centered };
   int DrawMode2D { Intersection };
   double Resolution { 45.0 };
+  int TubeSamplingMode { UniformSampling };
+  double TubeMaximumChordError { 0.1 };
+  int OutputPointsPrecision { vtkAlgorithm::SINGLE_PRECISION };
+  int OutputTopology { NativeTopology };
+  bool OutputNormals { true };
+  
+  int ResolutionMode { FixedResolution };
+  bool TubeMeshMeasurements { false };
+  bool AsynchronousMeasurements { false };
+  
+  // Shape geometry at one resolution.
+  struct ShapeWorldCache
+  {
+    vtkSmartPointer<vtkPolyData> ShapeWorld;
+    vtkSmartPointer<vtkTrivialProducer> Producer;
+    vtkTimeStamp BuildTime;
+    int NumberOfDefinedControlPoints { -1 };
+  };
+  ShapeWorldCache& GetShapeWorldCache(int resolution);
+  // By resolution : GetGeometryResolution() and per view levels.
+  std::map<int, ShapeWorldCache> ShapeWorldCaches;
+  // Modified by the setters of properties defining the geometry.
+  vtkTimeStamp ShapeParametersTime;
+  
+  double MeasurementValues[Measurement_Last] = { 0.0 };
+  bool MeasurementAvailable[Measurement_Last] = { false };
+  vtkTimeStamp MeasurementValuesBuildTime;
+  int MeasurementValuesNumberOfDefinedControlPoints { -1 };
+  // Tube mesh measurements in a worker thread.
+  struct AsynchronousMeasurement;
+  std::shared_ptr<AsynchronousMeasurement> PendingMeasurement;
+  struct MeasurementsReadyNotifier;
+  std::shared_ptr<MeasurementsReadyNotifier> MeasurementsReady;
+  // Workers of this node, superseded ones included, until they have finished.
+  std::vector<std::future<void>> AsynchronousMeasurementTasks;
+  void StartAsynchronousMeasurement(vtkPolyData * tubeWorld,
+                                    std::shared_ptr<AsynchronousMeasurement> previousMeasurement);
+  
+  double BoundingSphere[4] = { 0.0 }; // Center, radius
+  bool BoundingSphereDefined { false };
+  vtkTimeStamp BoundingSphereBuildTime;
+  int BoundingSphereNumberOfDefinedControlPoints { -1 };
+  
+  vtkSmartPointer<vtkDiskSource> DiskSource;
+  vtkSmartPointer<vtkRegularPolygonSource> RingSource;
+  vtkSmartPointer<vtkSphereSource> SphereSource;
+  vtkSmartPointer<vtkParametricSpline> Spline;
+  vtkSmartPointer<vtkParametricFunctionSource> SplineFunctionSource;
+  // Tube buffers, kept between updates.
+  vtkSmartPointer<vtkPoints> TubeSplinePoints; // Middle points of control point pairs
+  std::vector<double> TubeKnotRadii; // Radius at TubeSplinePoints
+  std::vector<double> TubeKnotParameters; // Spline parameter of TubeSplinePoints
+  vtkSmartPointer<vtkDoubleArray> TubeRadius; // Uniform sampling
+  vtkSmartPointer<vtkPoints> TubeSamples; // Adaptive sampling
+  vtkSmartPointer<vtkDoubleArray> TubeSampleParameters;
+  vtkSmartPointer<vtkDoubleArray> TubeCenterlineRadius;
+  vtkSmartPointer<vtkPolyData> TubeCenterline; // Adaptive sampling
+  vtkTimeStamp TubeCenterlineBuildTime;
+  int TubeCenterlineNumberOfControlPoints { -1 };
+  double TubeCenterlineSamplingFactor { 0.0 };
+  // Exposed copies of the centerline, see GetTubeCenterlinePoints().
+  vtkSmartPointer<vtkDoubleArray> TubeCenterlinePoints;
+  vtkSmartPointer<vtkDoubleArray> TubeCenterlineRadii;
+  vtkSmartPointer<vtkDoubleArray> TubeCenterlineArcLength;
+  vtkPolyData * TubeCenterlineArraysSource = nullptr;
+  vtkMTimeType TubeCenterlineArraysVersion { 0 };
+  vtkSmartPointer<vtkShapeTubeSweep> Tube;
+  vtkSmartPointer<vtkShapeSegmentedTube> SegmentedTube; // Segment sampling
   
-  vtkPolyData * ShapeWorld = nullptr;
   vtkMRMLNode * ResliceNode = nullptr;
 
 private:
-  bool RemovingPairControlPoint = false; // Tube
+  bool RemovingPairControlPoint = false; // Tube, sphere set
+  bool SnappingRingThirdPoint = false; // Ring
+  bool SettingTubeProfile = false; // Tube
   
 };
 
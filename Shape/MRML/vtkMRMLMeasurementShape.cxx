@@ -4,10 +4,10 @@
 
 // Markups includes
 #include "vtkMRMLMarkupsShapeNode.h"
+#include "vtkShapeTimingCounters.h"
 
-#include <vtkMath.h>
-#include <vtkTriangleFilter.h>
-#include <vtkMassProperties.h>
+// STD includes
+#include <map>
 
 vtkStandardNewMacro(vtkMRMLMeasurementShape);
 
@@ -24,250 +24,44 @@ void vtkMRMLMeasurementShape::PrintSelf(std::ostream& os, vtkIndent indent)
 }
 
 //----------------------------------------------------------------------------
-void vtkMRMLMeasurementShape::Compute()
+int vtkMRMLMeasurementShape::GetMeasurementType(const std::string& name)
 {
-  vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->InputMRMLNode);
-  if (!shapeNode)
-  {
-    this->SetValue(0.0, "#ERR");
-    return;
-  }
-  switch (shapeNode->GetShapeName())
-  {
-    case vtkMRMLMarkupsShapeNode::Sphere :
-      this->ComputeSphere();
-      break;
-    case vtkMRMLMarkupsShapeNode::Ring:
-      this->ComputeRing();
-      break;
-    case vtkMRMLMarkupsShapeNode::Disk:
-      this->ComputeDisk();
-      break;
-    case vtkMRMLMarkupsShapeNode::Tube:
-      this->ComputeTube();
-      break;
-    default :
-      vtkErrorMacro("Unknown shape.");
-      return;
+  static const std::map<std::string, int> measurementTypes =
+  {
+    { "radius", vtkMRMLMarkupsShapeNode::RadiusMeasurement },
+    { "innerRadius", vtkMRMLMarkupsShapeNode::InnerRadiusMeasurement },
+    { "outerRadius", vtkMRMLMarkupsShapeNode::OuterRadiusMeasurement },
+    { "width", vtkMRMLMarkupsShapeNode::WidthMeasurement },
+    { "area", vtkMRMLMarkupsShapeNode::AreaMeasurement },
+    { "innerArea", vtkMRMLMarkupsShapeNode::InnerAreaMeasurement },
+    { "outerArea", vtkMRMLMarkupsShapeNode::OuterAreaMeasurement },
+    { "volume", vtkMRMLMarkupsShapeNode::VolumeMeasurement }
   };
+  auto found = measurementTypes.find(name);
+  return (found == measurementTypes.end()) ? -1 : found->second;
 }
 
-
 //----------------------------------------------------------------------------
-void vtkMRMLMeasurementShape::ComputeDisk()
+void vtkMRMLMeasurementShape::Compute()
 {
-  double measurement = 0.0;
   vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->InputMRMLNode);
   if (!shapeNode)
   {
-      this->SetValue(measurement, "#ERR");
-      return;
-  }
-  
-  double closestPoint[3] = { 0.0 }; // Unused here
-  double farthestPoint[3] = { 0.0 };
-  double innerRadius = 0.0, outerRadius = 0.0;
-  if (!shapeNode->DescribeDiskPointSpacing(closestPoint, farthestPoint, innerRadius, outerRadius))
-  {
-    vtkDebugMacro("Point proximity description failure.");
-    return;
-  }
-  
-  if (this->GetName() == std::string("innerRadius"))
-  {
-    this->SetValue(innerRadius, this->GetName().c_str());
-  }
-  else
-  if (this->GetName() == std::string("outerRadius"))
-  {
-    this->SetValue(outerRadius, this->GetName().c_str());
-  }
-  else
-  if (this->GetName() == std::string("width"))
-    {
-      measurement = outerRadius - innerRadius;
-      this->SetValue(measurement, this->GetName().c_str());
-    }
-  else
-  if (this->GetName() == std::string("area"))
-  {
-    if (!shapeNode->GetShapeWorld())
-    {
-        this->SetValue(measurement, "#ERR");
-        return;
-    }
-    // vtkMassProperties fails here : <Input data type must be VTK_TRIANGLE not 9>.
-    const double innerArea = vtkMath::Pi() * innerRadius * innerRadius;
-    const double outerArea = vtkMath::Pi() * outerRadius * outerRadius;
-    measurement = outerArea - innerArea;
-    this->SetValue(measurement, this->GetName().c_str());
-  }
-  else
-  if (this->GetName() == std::string("innerArea"))
-  {
-    if (!shapeNode->GetShapeWorld())
-    {
-      this->SetValue(measurement, "#ERR");
-      return;
-    }
-    const double innerArea = vtkMath::Pi() * innerRadius * innerRadius;
-    this->SetValue(innerArea, this->GetName().c_str());
-  }
-  else
-    if (this->GetName() == std::string("outerArea"))
-    {
-      if (!shapeNode->GetShapeWorld())
-      {
-        this->SetValue(measurement, "#ERR");
-        return;
-      }
-      const double outerArea = vtkMath::Pi() * outerRadius * outerRadius;
-      this->SetValue(outerArea, this->GetName().c_str());
-    }
-  else
-  {
-    this->SetValue(measurement, "#ERR");
-  }
-  
-}
-
-//----------------------------------------------------------------------------
-void vtkMRMLMeasurementShape::ComputeRing()
-{
-  double measurement = 0.0;
-  vtkMRMLMarkupsShapeNode * ringNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->InputMRMLNode);
-  if (!ringNode)
-  {
-    this->SetValue(measurement, "#ERR");
-    return;
-  }
-  
-  double p1[3] = { 0.0 };
-  double p2[3] = { 0.0 };
-  ringNode->GetNthControlPointPositionWorld(0, p1);
-  ringNode->GetNthControlPointPositionWorld(1, p2);
-  const double lineLength = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
-  
-  if (this->GetName() == std::string("radius"))
-  {
-    if (ringNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
-    {
-      measurement = lineLength;
-    }
-    else
-    {
-      measurement = lineLength / 2.0;
-    }
-  }
-  else if (this->GetName() == std::string("area"))
-  {
-    if (ringNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
-    {
-      measurement = vtkMath::Pi() * (lineLength * lineLength);
-    }
-    else
-    {
-      double radius = lineLength / 2.0;
-      measurement = vtkMath::Pi() * (radius * radius);
-    }
-  }
-  else
-  {
-    this->SetValue(measurement, "#ERR");
-    return;
-  }
-  this->SetValue(measurement, this->GetName().c_str());
-}
-
-//----------------------------------------------------------------------------
-void vtkMRMLMeasurementShape::ComputeSphere()
-{
-  double measurement = 0.0;
-  vtkMRMLMarkupsShapeNode * sphereNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->InputMRMLNode);
-  if (!sphereNode)
-  {
-    this->SetValue(measurement, "#ERR");
-    return;
-  }
-  
-  double p1[3] = { 0.0 };
-  double p2[3] = { 0.0 };
-  sphereNode->GetNthControlPointPositionWorld(0, p1);
-  sphereNode->GetNthControlPointPositionWorld(1, p2);
-  const double lineLength = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
-  
-  if (this->GetName() == std::string("radius"))
-  {
-    if (sphereNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
-    {
-      measurement = lineLength;
-    }
-    else
-    {
-      measurement = lineLength / 2.0;
-    }
-  }
-  else
-  if (this->GetName() == std::string("area"))
-  {
-    if (sphereNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
-    {
-      measurement = 4.0 * vtkMath::Pi() * (lineLength * lineLength);
-    }
-    else
-    {
-      double radius = lineLength / 2.0;
-      measurement = 4.0 * vtkMath::Pi() * (radius * radius);
-    }
-  }
-  else
-  if (this->GetName() == std::string("volume"))
-  {
-    if (sphereNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
-    {
-      measurement = (4.0 / 3.0) * vtkMath::Pi() * (lineLength * lineLength * lineLength);
-    }
-    else
-    {
-      double radius = lineLength / 2.0;
-      measurement = (4.0 / 3.0) * vtkMath::Pi() * (radius * radius * radius);
-    }
-  }
-  else
-  {
-    this->SetValue(measurement, "#ERR");
+    this->SetValue(0.0, "#ERR");
     return;
   }
-  this->SetValue(measurement, this->GetName().c_str());
-}
-
-//----------------------------------------------------------------------------
-void vtkMRMLMeasurementShape::ComputeTube()
-{
+  vtkShapeTimingCounters::ScopedTimer timer("MeasurementCompute", shapeNode->GetShapeName());
+  // Evaluated once by the node for all measurements.
+  const int measurementType = GetMeasurementType(this->GetName());
   double measurement = 0.0;
-  vtkMRMLMarkupsShapeNode * tubeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->InputMRMLNode);
-  if (!tubeNode || tubeNode->GetShapeWorld() == nullptr)
+  const bool available = shapeNode->GetMeasurementValue(measurementType, measurement);
+  if (shapeNode->IsMeasurementPending(measurementType))
   {
-    this->SetValue(measurement, "#ERR");
+    // The previous value, until the node publishes the new one.
+    this->SetValue(measurement, "#PENDING");
     return;
   }
-  vtkNew<vtkTriangleFilter> triangleFilter;
-  vtkNew<vtkMassProperties> massProperties;
-  triangleFilter->SetInputData(tubeNode->GetShapeWorld());
-  triangleFilter->Update();
-  massProperties->SetInputData(triangleFilter->GetOutput());
-  massProperties->Update();
-  
-  if (this->GetName() == std::string("area"))
-  {
-    measurement = massProperties->GetSurfaceArea();
-  }
-  else
-  if (this->GetName() == std::string("volume"))
-  {
-    measurement = massProperties->GetVolume();
-  }
-  else
+  if (!available)
   {
     this->SetValue(measurement, "#ERR");
     return;
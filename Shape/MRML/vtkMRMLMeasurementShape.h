@@ -7,6 +7,9 @@
 // Markups includes
 #include "vtkSlicerMarkupsModuleMRMLExport.h"
 
+// STD includes
+#include <string>
+
 class VTK_SLICER_MARKUPS_MODULE_MRML_EXPORT vtkMRMLMeasurementShape : public vtkMRMLMeasurement
 {
 public:
@@ -20,16 +23,15 @@ public:
     { return vtkMRMLMeasurementShape::New(); }
     void Compute() override;
     
+    /// Measurement type of vtkMRMLMarkupsShapeNode corresponding to a measurement name,
+    /// -1 if unknown.
+    static int GetMeasurementType(const std::string& name);
+    
 protected:
     vtkMRMLMeasurementShape();
     ~vtkMRMLMeasurementShape() override;
     vtkMRMLMeasurementShape(const vtkMRMLMeasurementShape&);
     void operator=(const vtkMRMLMeasurementShape&);
-    
-    void ComputeDisk();
-    void ComputeRing();
-    void ComputeSphere();
-    void ComputeTube();
 };
 
 #endif // VTKMRMLMEASUREMENTSHAPE_H
@@ -0,0 +1,424 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#include "vtkShapeSegmentedTube.h"
+#include "vtkShapeTubeSweep.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Knot distances at this power define the centripetal parameterization.
+const double KnotSpacingExponent = 0.5;
+const double MinimumKnotSpacing = 1e-6;
+
+//----------------------------------------------------------------------------
+double Interpolate(double t, double t1, double t2, double value1, double value2)
+{
+  return ((t2 - t) * value1 + (t - t1) * value2) / (t2 - t1);
+}
+
+//----------------------------------------------------------------------------
+void RotateAroundAxis(double * vector, const double * axis, double angle)
+{
+  double cross[3] = { 0.0 };
+  vtkMath::Cross(axis, vector, cross);
+  const double c = std::cos(angle);
+  const double s = std::sin(angle);
+  for (int i = 0; i < 3; i++)
+  {
+    vector[i] = c * vector[i] + s * cross[i];
+  }
+}
+} // end of anonymous namespace
+
+vtkStandardNewMacro(vtkShapeSegmentedTube);
+
+//----------------------------------------------------------------------------
+vtkShapeSegmentedTube::vtkShapeSegmentedTube()
+{
+  this->Samples = vtkSmartPointer<vtkPoints>::New();
+  this->Samples->SetDataTypeToDouble();
+  this->SampleRadii = vtkSmartPointer<vtkDoubleArray>::New();
+  this->SampleRadii->SetName("TubeRadius");
+  this->Centerline = vtkSmartPointer<vtkPolyData>::New();
+  this->Centerline->SetPoints(this->Samples);
+  vtkNew<vtkCellArray> lines;
+  this->Centerline->SetLines(lines);
+  this->Centerline->GetPointData()->AddArray(this->SampleRadii);
+  this->Centerline->GetPointData()->SetActiveScalars("TubeRadius");
+}
+
+//----------------------------------------------------------------------------
+vtkShapeSegmentedTube::~vtkShapeSegmentedTube() = default;
+
+//----------------------------------------------------------------------------
+void vtkShapeSegmentedTube::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfSegments: " << this->NumberOfSegments << std::endl;
+  os << indent << "SamplesPerSegment: " << this->SamplesPerSegment << std::endl;
+  os << indent << "NumberOfResampledSegments: " << this->NumberOfResampledSegments << std::endl;
+  os << indent << "NumberOfSweptSegments: " << this->NumberOfSweptSegments << std::endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeSegmentedTube::Reset()
+{
+  this->Knots.clear();
+  this->Radii.clear();
+  this->NumberOfSegments = 0;
+  this->SamplesPerSegment = 0;
+  this->Samples->Reset();
+  this->SampleRadii->Reset();
+  this->Centerline->GetLines()->Reset();
+  this->Centerline->Modified();
+  this->Tangents.clear();
+  this->Normals.clear();
+  this->SegmentVersions.clear();
+  this->Surfaces.clear();
+  this->NumberOfResampledSegments = 0;
+  this->NumberOfSweptSegments = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkShapeSegmentedTube::GetFirstSample(int segment)
+{
+  return (vtkIdType) segment * this->SamplesPerSegment;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkShapeSegmentedTube::GetLastSample(int segment)
+{
+  // The last segment also holds the sample at the last knot.
+  return (segment == this->NumberOfSegments - 1) ? this->GetFirstSample(segment + 1)
+                                                 : this->GetFirstSample(segment + 1) - 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeSegmentedTube::SetKnots(vtkPoints * knots, const std::vector<double>& radii, int samplesPerSegment)
+{
+  const int numberOfKnots = knots ? (int) knots->GetNumberOfPoints() : 0;
+  if (numberOfKnots < 2 || (int) radii.size() < numberOfKnots || samplesPerSegment < 1)
+  {
+    this->Reset();
+    return;
+  }
+  const int numberOfSegments = numberOfKnots - 1;
+  const bool rebuild = (numberOfSegments != this->NumberOfSegments
+                        || samplesPerSegment != this->SamplesPerSegment);
+  std::vector<bool> outdatedSegments(numberOfSegments, rebuild);
+  this->Knots.resize(3 * numberOfKnots);
+  this->Radii.resize(numberOfKnots);
+  for (int k = 0; k < numberOfKnots; k++)
+  {
+    double knot[3] = { 0.0 };
+    knots->GetPoint(k, knot);
+    double * previousKnot = this->Knots.data() + 3 * k;
+    if (previousKnot[0] == knot[0] && previousKnot[1] == knot[1] && previousKnot[2] == knot[2]
+      && this->Radii[k] == radii[k])
+    {
+      continue;
+    }
+    previousKnot[0] = knot[0];
+    previousKnot[1] = knot[1];
+    previousKnot[2] = knot[2];
+    this->Radii[k] = radii[k];
+    // Segments using this knot.
+    for (int i = std::max(0, k - 2); i <= std::min(numberOfSegments - 1, k + 1); i++)
+    {
+      outdatedSegments[i] = true;
+    }
+  }
+  
+  if (rebuild)
+  {
+    this->NumberOfSegments = numberOfSegments;
+    this->SamplesPerSegment = samplesPerSegment;
+    const vtkIdType numberOfSamples = this->GetLastSample(numberOfSegments - 1) + 1;
+    this->Samples->SetNumberOfPoints(numberOfSamples);
+    this->SampleRadii->SetNumberOfTuples(numberOfSamples);
+    this->Tangents.assign(3 * numberOfSamples, 0.0);
+    this->Normals.assign(3 * numberOfSamples, 0.0);
+    this->SegmentVersions.assign(numberOfSegments, 0);
+    vtkCellArray * lines = this->Centerline->GetLines();
+    lines->Reset();
+    lines->InsertNextCell(numberOfSamples);
+    for (vtkIdType i = 0; i < numberOfSamples; i++)
+    {
+      lines->InsertCellPoint(i);
+    }
+    lines->Modified();
+  }
+  
+  this->NumberOfResampledSegments = 0;
+  for (int i = 0; i < numberOfSegments; i++)
+  {
+    if (outdatedSegments[i])
+    {
+      this->ResampleSegment(i);
+      this->SegmentVersions[i] = ++this->LastSegmentVersion;
+      this->NumberOfResampledSegments++;
+    }
+  }
+  if (this->NumberOfResampledSegments == 0)
+  {
+    return;
+  }
+  // Frames, by runs of resampled segments.
+  for (int i = 0; i < numberOfSegments; i++)
+  {
+    if (!outdatedSegments[i])
+    {
+      continue;
+    }
+    int last = i;
+    while (last + 1 < numberOfSegments && outdatedSegments[last + 1])
+    {
+      last++;
+    }
+    this->PropagateFrames(this->GetFirstSample(i), this->GetLastSample(last));
+    i = last;
+  }
+  this->Samples->Modified();
+  this->SampleRadii->Modified();
+  this->Centerline->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeSegmentedTube::EvaluateSegment(int segment, double s, double * position)
+{
+  // Knots segment - 1 to segment + 2; missing end knots are mirrored.
+  const int lastKnot = this->NumberOfSegments;
+  const double * knots = this->Knots.data();
+  double p[4][3];
+  for (int j = 0; j < 4; j++)
+  {
+    const int k = segment - 1 + j;
+    for (int c = 0; c < 3; c++)
+    {
+      if (k < 0)
+      {
+        p[j][c] = 2.0 * knots[c] - knots[3 + c];
+      }
+      else if (k > lastKnot)
+      {
+        p[j][c] = 2.0 * knots[3 * lastKnot + c] - knots[3 * (lastKnot - 1) + c];
+      }
+      else
+      {
+        p[j][c] = knots[3 * k + c];
+      }
+    }
+  }
+  double t[4] = { 0.0 };
+  for (int j = 1; j < 4; j++)
+  {
+    const double spacing = std::pow(vtkMath::Distance2BetweenPoints(p[j - 1], p[j]), KnotSpacingExponent / 2.0);
+    t[j] = t[j - 1] + std::max(spacing, MinimumKnotSpacing);
+  }
+  // Barry and Goldman's pyramidal formulation.
+  const double u = t[1] + s * (t[2] - t[1]);
+  for (int c = 0; c < 3; c++)
+  {
+    const double a1 = Interpolate(u, t[0], t[1], p[0][c], p[1][c]);
+    const double a2 = Interpolate(u, t[1], t[2], p[1][c], p[2][c]);
+    const double a3 = Interpolate(u, t[2], t[3], p[2][c], p[3][c]);
+    const double b1 = Interpolate(u, t[0], t[2], a1, a2);
+    const double b2 = Interpolate(u, t[1], t[3], a2, a3);
+    position[c] = Interpolate(u, t[1], t[2], b1, b2);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeSegmentedTube::ResampleSegment(int segment)
+{
+  const vtkIdType firstSample = this->GetFirstSample(segment);
+  const vtkIdType lastSample = this->GetLastSample(segment);
+  double chord[3] = { 0.0 };
+  vtkMath::Subtract(this->Knots.data() + 3 * (segment + 1), this->Knots.data() + 3 * segment, chord);
+  const double step = 1e-3;
+  for (vtkIdType m = firstSample; m <= lastSample; m++)
+  {
+    const double s = (double) (m - firstSample) / (double) this->SamplesPerSegment;
+    double position[3] = { 0.0 };
+    this->EvaluateSegment(segment, s, position);
+    this->Samples->SetPoint(m, position);
+    this->SampleRadii->SetValue(m, this->Radii[segment] + s * (this->Radii[segment + 1] - this->Radii[segment]));
+    // The segment polynomial extends beyond [0, 1] : samples at knots take the tangent of their own segment.
+    double before[3] = { 0.0 };
+    double after[3] = { 0.0 };
+    this->EvaluateSegment(segment, s - step, before);
+    this->EvaluateSegment(segment, s + step, after);
+    double * tangent = this->Tangents.data() + 3 * m;
+    vtkMath::Subtract(after, before, tangent);
+    if (vtkMath::Normalize(tangent) == 0.0)
+    {
+      tangent[0] = chord[0];
+      tangent[1] = chord[1];
+      tangent[2] = chord[2];
+      if (vtkMath::Normalize(tangent) == 0.0)
+      {
+        tangent[0] = 1.0;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeSegmentedTube::PropagateFrames(vtkIdType first, vtkIdType last)
+{
+  double * tangents = this->Tangents.data();
+  double * normals = this->Normals.data();
+  vtkIdType start = first;
+  if (first == 0)
+  {
+    vtkShapeTubeSweep::GetInitialNormal(tangents, normals);
+    start = 1;
+  }
+  double previousPosition[3] = { 0.0 };
+  double position[3] = { 0.0 };
+  if (start > 0)
+  {
+    this->Samples->GetPoint(start - 1, previousPosition);
+  }
+  for (vtkIdType m = start; m <= last; m++)
+  {
+    this->Samples->GetPoint(m, position);
+    vtkShapeTubeSweep::PropagateNormal(previousPosition, tangents + 3 * (m - 1), normals + 3 * (m - 1),
+                    position, tangents + 3 * m, normals + 3 * m);
+    previousPosition[0] = position[0];
+    previousPosition[1] = position[1];
+    previousPosition[2] = position[2];
+  }
+  
+  // Join the frame kept at the next sample.
+  if (last + 1 >= this->Samples->GetNumberOfPoints())
+  {
+    return;
+  }
+  double predicted[3] = { 0.0 };
+  this->Samples->GetPoint(last + 1, position);
+  vtkShapeTubeSweep::PropagateNormal(previousPosition, tangents + 3 * last, normals + 3 * last,
+                  position, tangents + 3 * (last + 1), predicted);
+  const double * target = normals + 3 * (last + 1);
+  double cross[3] = { 0.0 };
+  vtkMath::Cross(predicted, target, cross);
+  const double twist = std::atan2(vtkMath::Dot(cross, tangents + 3 * (last + 1)), vtkMath::Dot(predicted, target));
+  const double numberOfSteps = (double) (last - first + 2);
+  for (vtkIdType m = first; m <= last; m++)
+  {
+    RotateAroundAxis(normals + 3 * m, tangents + 3 * m, twist * (m - first + 1) / numberOfSteps);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkPolyData * vtkShapeSegmentedTube::GetCenterline()
+{
+  return this->Centerline;
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeSegmentedTube::BuildSurfaceTopology(Surface& surface, int numberOfSides)
+{
+  const vtkIdType numberOfSamples = this->Samples->GetNumberOfPoints();
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(numberOfSamples * numberOfSides);
+  vtkNew<vtkFloatArray> normals;
+  normals->SetName("TubeNormals");
+  normals->SetNumberOfComponents(3);
+  normals->SetNumberOfTuples(numberOfSamples * numberOfSides);
+  vtkNew<vtkDoubleArray> radii;
+  radii->SetName("TubeRadius");
+  radii->SetNumberOfTuples(numberOfSamples * numberOfSides);
+  vtkNew<vtkCellArray> strips;
+  vtkShapeTubeSweep::BuildStrips(numberOfSamples, numberOfSides, strips);
+  surface.PolyData = vtkSmartPointer<vtkPolyData>::New();
+  surface.PolyData->SetPoints(points);
+  surface.PolyData->SetStrips(strips);
+  surface.PolyData->GetPointData()->SetNormals(normals);
+  surface.PolyData->GetPointData()->AddArray(radii);
+  surface.PolyData->GetPointData()->SetActiveScalars("TubeRadius");
+  surface.SegmentVersions.assign(this->NumberOfSegments, 0);
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeSegmentedTube::SweepSegment(Surface& surface, int numberOfSides, int segment)
+{
+  vtkFloatArray * points = vtkFloatArray::SafeDownCast(surface.PolyData->GetPoints()->GetData());
+  vtkFloatArray * normals = vtkFloatArray::SafeDownCast(surface.PolyData->GetPointData()->GetNormals());
+  vtkDoubleArray * radii = vtkDoubleArray::SafeDownCast(surface.PolyData->GetPointData()->GetArray("TubeRadius"));
+  vtkShapeTubeSweep::SweepRings(this->Samples, this->SampleRadii, this->Tangents.data(), this->Normals.data(),
+                                numberOfSides, this->GetFirstSample(segment), this->GetLastSample(segment),
+                                points->GetPointer(0), normals->GetPointer(0), radii->GetPointer(0));
+}
+
+//----------------------------------------------------------------------------
+vtkPolyData * vtkShapeSegmentedTube::UpdateSurface(int numberOfSides)
+{
+  numberOfSides = std::max(numberOfSides, 3);
+  Surface& surface = this->Surfaces[numberOfSides];
+  this->NumberOfSweptSegments = 0;
+  if (this->NumberOfSegments == 0)
+  {
+    if (!surface.PolyData)
+    {
+      surface.PolyData = vtkSmartPointer<vtkPolyData>::New();
+    }
+    surface.PolyData->Initialize();
+    return surface.PolyData;
+  }
+  if (!surface.PolyData || (int) surface.SegmentVersions.size() != this->NumberOfSegments
+    || surface.PolyData->GetNumberOfPoints() != this->Samples->GetNumberOfPoints() * numberOfSides)
+  {
+    this->BuildSurfaceTopology(surface, numberOfSides);
+  }
+  for (int i = 0; i < this->NumberOfSegments; i++)
+  {
+    if (surface.SegmentVersions[i] != this->SegmentVersions[i])
+    {
+      this->SweepSegment(surface, numberOfSides, i);
+      surface.SegmentVersions[i] = this->SegmentVersions[i];
+      this->NumberOfSweptSegments++;
+    }
+  }
+  if (this->NumberOfSweptSegments > 0)
+  {
+    surface.PolyData->GetPoints()->Modified();
+    surface.PolyData->GetPointData()->GetNormals()->Modified();
+    surface.PolyData->GetPointData()->GetArray("TubeRadius")->Modified();
+    surface.PolyData->Modified();
+  }
+  return surface.PolyData;
+}
@@ -0,0 +1,114 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#ifndef __vtkshapesegmentedtube_h_
+#define __vtkshapesegmentedtube_h_
+
+#include "vtkSlicerShapeModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <map>
+#include <vector>
+
+class vtkDoubleArray;
+class vtkPoints;
+class vtkPolyData;
+
+/**
+ * Tube through knots with a radius at each knot, updated segment by segment.
+ *
+ * The centerline is a centripetal Catmull-Rom spline : a segment between two knots
+ * depends on four knots only. When knots move, only the segments next to them are
+ * resampled, and only these segments of the swept surfaces are regenerated; the
+ * output points are patched in place. The frames along the centerline rotate as
+ * little as possible, a twist is spread over the regenerated samples to join the
+ * frames of the unchanged segments.
+ */
+class VTK_SLICER_SHAPE_MODULE_MRML_EXPORT vtkShapeSegmentedTube : public vtkObject
+{
+public:
+  static vtkShapeSegmentedTube *New();
+  vtkTypeMacro(vtkShapeSegmentedTube, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Resample the segments next to the knots that changed since the last call.
+  /// All segments are resampled if the number of knots or samplesPerSegment changed.
+  void SetKnots(vtkPoints * knots, const std::vector<double>& radii, int samplesPerSegment);
+  /// Centerline samples, one polyline with a TubeRadius point array.
+  vtkPolyData * GetCenterline();
+  /// Tube surface with numberOfSides, as triangle strips with point normals and TubeRadius.
+  /// Only the segments resampled since the last update with the same number of sides are swept.
+  vtkPolyData * UpdateSurface(int numberOfSides);
+  /// Forget the knots and all surfaces.
+  void Reset();
+
+  vtkGetMacro(NumberOfSegments, int);
+  /// Segments resampled by the last SetKnots(), swept by the last UpdateSurface().
+  vtkGetMacro(NumberOfResampledSegments, int);
+  vtkGetMacro(NumberOfSweptSegments, int);
+
+protected:
+  vtkShapeSegmentedTube();
+  ~vtkShapeSegmentedTube() override;
+
+  // Position on segment at s in [0, 1], from the knots around it.
+  void EvaluateSegment(int segment, double s, double * position);
+  void ResampleSegment(int segment);
+  // Frames of samples first to last, from the frame before first or from an initial frame.
+  // If the sample after last keeps its frame, the twist to join it is spread over the range.
+  void PropagateFrames(vtkIdType first, vtkIdType last);
+  vtkIdType GetFirstSample(int segment);
+  vtkIdType GetLastSample(int segment);
+
+  // Surface at one number of sides.
+  struct Surface
+  {
+    vtkSmartPointer<vtkPolyData> PolyData;
+    std::vector<unsigned long> SegmentVersions;
+  };
+  void BuildSurfaceTopology(Surface& surface, int numberOfSides);
+  void SweepSegment(Surface& surface, int numberOfSides, int segment);
+
+  std::vector<double> Knots; // 3 components
+  std::vector<double> Radii;
+  int NumberOfSegments { 0 };
+  int SamplesPerSegment { 0 };
+  vtkSmartPointer<vtkPolyData> Centerline;
+  vtkSmartPointer<vtkPoints> Samples;
+  vtkSmartPointer<vtkDoubleArray> SampleRadii;
+  std::vector<double> Tangents; // 3 components per sample
+  std::vector<double> Normals; // 3 components per sample
+  // Incremented on each segment resampling.
+  std::vector<unsigned long> SegmentVersions;
+  unsigned long LastSegmentVersion { 0 };
+  std::map<int, Surface> Surfaces;
+  int NumberOfResampledSegments { 0 };
+  int NumberOfSweptSegments { 0 };
+
+private:
+  vtkShapeSegmentedTube(const vtkShapeSegmentedTube&) = delete;
+  void operator=(const vtkShapeSegmentedTube&) = delete;
+};
+
+#endif // __vtkshapesegmentedtube_h_
@@ -0,0 +1,164 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#include "vtkShapeTimingCounters.h"
+#include "vtkMRMLMarkupsShapeNode.h"
+
+// VTK includes
+#include <vtkDoubleArray.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkStringArray.h>
+#include <vtkTable.h>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace
+{
+struct Counter
+{
+  int Calls { 0 };
+  double Total { 0.0 };
+  double Maximum { 0.0 };
+};
+
+std::atomic<bool> TimingEnabled { false };
+std::mutex CountersMutex;
+std::map<std::pair<std::string, int>, Counter> Counters;
+
+} // end of anonymous namespace
+
+vtkStandardNewMacro(vtkShapeTimingCounters);
+
+//----------------------------------------------------------------------------
+void vtkShapeTimingCounters::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Enabled: " << GetEnabled() << std::endl;
+  std::lock_guard<std::mutex> lock(CountersMutex);
+  for (const auto& item : Counters)
+  {
+    os << indent << item.first.first << " (" << vtkMRMLMarkupsShapeNode::GetShapeNameAsString(item.first.second) << "): "
+       << item.second.Calls << " calls, " << item.second.Total * 1000.0 << " ms, max "
+       << item.second.Maximum * 1000.0 << " ms" << std::endl;
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTimingCounters::SetEnabled(bool enabled)
+{
+  TimingEnabled = enabled;
+}
+
+//----------------------------------------------------------------------------
+bool vtkShapeTimingCounters::GetEnabled()
+{
+  return TimingEnabled;
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTimingCounters::Reset()
+{
+  std::lock_guard<std::mutex> lock(CountersMutex);
+  Counters.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTimingCounters::AddTime(const char * stage, int shapeName, double seconds)
+{
+  if (!stage)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(CountersMutex);
+  Counter& counter = Counters[std::make_pair(std::string(stage), shapeName)];
+  counter.Calls++;
+  counter.Total += seconds;
+  counter.Maximum = std::max(counter.Maximum, seconds);
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTimingCounters::GetTimings(vtkTable * table)
+{
+  if (!table)
+  {
+    vtkGenericWarningMacro("Table is nullptr.");
+    return;
+  }
+  vtkNew<vtkStringArray> stages;
+  stages->SetName("Stage");
+  vtkNew<vtkStringArray> shapes;
+  shapes->SetName("Shape");
+  vtkNew<vtkIntArray> calls;
+  calls->SetName("Calls");
+  vtkNew<vtkDoubleArray> totals;
+  totals->SetName("TotalMs");
+  vtkNew<vtkDoubleArray> means;
+  means->SetName("MeanMs");
+  vtkNew<vtkDoubleArray> maximums;
+  maximums->SetName("MaxMs");
+  {
+    std::lock_guard<std::mutex> lock(CountersMutex);
+    for (const auto& item : Counters)
+    {
+      const Counter& counter = item.second;
+      stages->InsertNextValue(item.first.first);
+      shapes->InsertNextValue(vtkMRMLMarkupsShapeNode::GetShapeNameAsString(item.first.second));
+      calls->InsertNextValue(counter.Calls);
+      totals->InsertNextValue(counter.Total * 1000.0);
+      means->InsertNextValue(counter.Total * 1000.0 / counter.Calls);
+      maximums->InsertNextValue(counter.Maximum * 1000.0);
+    }
+  }
+  table->Initialize();
+  table->AddColumn(stages);
+  table->AddColumn(shapes);
+  table->AddColumn(calls);
+  table->AddColumn(totals);
+  table->AddColumn(means);
+  table->AddColumn(maximums);
+}
+
+//----------------------------------------------------------------------------
+vtkShapeTimingCounters::ScopedTimer::ScopedTimer(const char * stage, int shapeName)
+: Stage(stage), ShapeName(shapeName), Active(TimingEnabled)
+{
+  if (this->Active)
+  {
+    this->Start = std::chrono::steady_clock::now();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkShapeTimingCounters::ScopedTimer::~ScopedTimer()
+{
+  if (this->Active)
+  {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->Start;
+    vtkShapeTimingCounters::AddTime(this->Stage, this->ShapeName, elapsed.count());
+  }
+}
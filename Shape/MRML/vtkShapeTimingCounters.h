@@ -0,0 +1,80 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#ifndef __vtkshapetimingcounters_h_
+#define __vtkshapetimingcounters_h_
+
+#include "vtkSlicerShapeModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <chrono>
+
+class vtkTable;
+
+/**
+ * Process wide timing of the Shape hot paths : call count, cumulative and maximum times
+ * by stage and shape type. Disabled by default; a disabled ScopedTimer costs a test.
+ * Use vtkSlicerShapeLogic to enable, query and reset.
+ */
+class VTK_SLICER_SHAPE_MODULE_MRML_EXPORT vtkShapeTimingCounters : public vtkObject
+{
+public:
+  static vtkShapeTimingCounters *New();
+  vtkTypeMacro(vtkShapeTimingCounters, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  static void SetEnabled(bool enabled);
+  static bool GetEnabled();
+  static void Reset();
+  /// Accumulate one call of stage on a vtkMRMLMarkupsShapeNode::ShapeName.
+  static void AddTime(const char * stage, int shapeName, double seconds);
+  /// Columns : Stage, Shape (strings); Calls (int); TotalMs, MeanMs, MaxMs (double).
+  static void GetTimings(vtkTable * table);
+
+#ifndef __VTK_WRAP__
+  /// Times its own scope if counters are enabled on construction.
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer(const char * stage, int shapeName);
+    ~ScopedTimer();
+  private:
+    ScopedTimer(const ScopedTimer&) = delete;
+    void operator=(const ScopedTimer&) = delete;
+    const char * Stage { nullptr };
+    int ShapeName { -1 };
+    bool Active { false };
+    std::chrono::steady_clock::time_point Start;
+  };
+#endif
+
+protected:
+  vtkShapeTimingCounters() = default;
+  ~vtkShapeTimingCounters() override = default;
+
+private:
+  vtkShapeTimingCounters(const vtkShapeTimingCounters&) = delete;
+  void operator=(const vtkShapeTimingCounters&) = delete;
+};
+
+#endif // __vtkshapetimingcounters_h_
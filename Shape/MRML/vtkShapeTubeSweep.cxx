@@ -0,0 +1,317 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#include "vtkShapeTubeSweep.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+vtkStandardNewMacro(vtkShapeTubeSweep);
+
+//----------------------------------------------------------------------------
+vtkShapeTubeSweep::vtkShapeTubeSweep() = default;
+
+//----------------------------------------------------------------------------
+vtkShapeTubeSweep::~vtkShapeTubeSweep() = default;
+
+//----------------------------------------------------------------------------
+void vtkShapeTubeSweep::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfSides: " << this->NumberOfSides << std::endl;
+}
+
+//----------------------------------------------------------------------------
+int vtkShapeTubeSweep::RequestData(vtkInformation * vtkNotUsed(request),
+                                   vtkInformationVector ** inputVector,
+                                   vtkInformationVector * outputVector)
+{
+  vtkPolyData * input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData * output = vtkPolyData::GetData(outputVector);
+  if (!input || !output)
+  {
+    return 0;
+  }
+  vtkPoints * samples = input->GetPoints();
+  const vtkIdType numberOfSamples = samples ? samples->GetNumberOfPoints() : 0;
+  if (numberOfSamples < 2)
+  {
+    return 1;
+  }
+  vtkDataArray * radii = input->GetPointData()->GetScalars();
+  if (!radii)
+  {
+    radii = input->GetPointData()->GetArray("TubeRadius");
+  }
+  if (!radii)
+  {
+    vtkErrorMacro("No radius array.");
+    return 0;
+  }
+  
+  std::vector<double> tangents(3 * numberOfSamples);
+  std::vector<double> normals(3 * numberOfSamples);
+  vtkShapeTubeSweep::ComputeTangents(samples, tangents.data());
+  vtkShapeTubeSweep::ComputeNormals(samples, tangents.data(), normals.data());
+  
+  const int numberOfSides = this->NumberOfSides;
+  const vtkIdType numberOfRingPoints = numberOfSamples * numberOfSides;
+  vtkNew<vtkPoints> ringPoints;
+  ringPoints->SetDataTypeToFloat();
+  ringPoints->SetNumberOfPoints(numberOfRingPoints);
+  vtkNew<vtkFloatArray> ringNormals;
+  ringNormals->SetName("TubeNormals");
+  ringNormals->SetNumberOfComponents(3);
+  ringNormals->SetNumberOfTuples(numberOfRingPoints);
+  vtkNew<vtkDoubleArray> ringRadii;
+  ringRadii->SetName("TubeRadius");
+  ringRadii->SetNumberOfTuples(numberOfRingPoints);
+  vtkShapeTubeSweep::SweepRings(samples, radii, tangents.data(), normals.data(), numberOfSides,
+                                0, numberOfSamples - 1,
+                                vtkFloatArray::SafeDownCast(ringPoints->GetData())->GetPointer(0),
+                                ringNormals->GetPointer(0), ringRadii->GetPointer(0));
+  vtkNew<vtkCellArray> strips;
+  vtkShapeTubeSweep::BuildStrips(numberOfSamples, numberOfSides, strips);
+  
+  output->SetPoints(ringPoints);
+  output->SetStrips(strips);
+  output->GetPointData()->SetNormals(ringNormals);
+  output->GetPointData()->AddArray(ringRadii);
+  output->GetPointData()->SetActiveScalars("TubeRadius");
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTubeSweep::ComputeTangents(vtkPoints * samples, double * tangents)
+{
+  const vtkIdType numberOfSamples = samples->GetNumberOfPoints();
+  if (numberOfSamples < 2)
+  {
+    return;
+  }
+  vtkSMPTools::For(0, numberOfSamples, [&](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      double before[3] = { 0.0 };
+      double after[3] = { 0.0 };
+      samples->GetPoint(std::max<vtkIdType>(i - 1, 0), before);
+      samples->GetPoint(std::min<vtkIdType>(i + 1, numberOfSamples - 1), after);
+      double * tangent = tangents + 3 * i;
+      vtkMath::Subtract(after, before, tangent);
+      vtkMath::Normalize(tangent);
+    }
+  });
+  // Repeated samples : keep the closest valid tangent, sequentially.
+  vtkIdType firstValid = 0;
+  while (firstValid < numberOfSamples && vtkMath::Norm(tangents + 3 * firstValid) == 0.0)
+  {
+    firstValid++;
+  }
+  if (firstValid == numberOfSamples)
+  {
+    for (vtkIdType i = 0; i < numberOfSamples; i++)
+    {
+      tangents[3 * i] = 1.0;
+    }
+    return;
+  }
+  for (vtkIdType i = 0; i < numberOfSamples; i++)
+  {
+    if (vtkMath::Norm(tangents + 3 * i) == 0.0)
+    {
+      const vtkIdType source = (i < firstValid) ? firstValid : i - 1;
+      tangents[3 * i] = tangents[3 * source];
+      tangents[3 * i + 1] = tangents[3 * source + 1];
+      tangents[3 * i + 2] = tangents[3 * source + 2];
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTubeSweep::ComputeNormals(vtkPoints * samples, const double * tangents, double * normals)
+{
+  const vtkIdType numberOfSamples = samples->GetNumberOfPoints();
+  if (numberOfSamples == 0)
+  {
+    return;
+  }
+  vtkShapeTubeSweep::GetInitialNormal(tangents, normals);
+  double previousPosition[3] = { 0.0 };
+  samples->GetPoint(0, previousPosition);
+  for (vtkIdType i = 1; i < numberOfSamples; i++)
+  {
+    double position[3] = { 0.0 };
+    samples->GetPoint(i, position);
+    vtkShapeTubeSweep::PropagateNormal(previousPosition, tangents + 3 * (i - 1), normals + 3 * (i - 1),
+                                       position, tangents + 3 * i, normals + 3 * i);
+    previousPosition[0] = position[0];
+    previousPosition[1] = position[1];
+    previousPosition[2] = position[2];
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTubeSweep::GetInitialNormal(const double * tangent, double * normal)
+{
+  int axis = 0;
+  for (int c = 1; c < 3; c++)
+  {
+    if (std::fabs(tangent[c]) < std::fabs(tangent[axis]))
+    {
+      axis = c;
+    }
+  }
+  normal[0] = normal[1] = normal[2] = 0.0;
+  normal[axis] = 1.0;
+  const double along = vtkMath::Dot(normal, tangent);
+  for (int c = 0; c < 3; c++)
+  {
+    normal[c] -= along * tangent[c];
+  }
+  vtkMath::Normalize(normal);
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTubeSweep::PropagateNormal(const double * x0, const double * t0, const double * r0,
+                                        const double * x1, const double * t1, double * r1)
+{
+  double v1[3] = { x1[0] - x0[0], x1[1] - x0[1], x1[2] - x0[2] };
+  const double c1 = vtkMath::Dot(v1, v1);
+  double rL[3] = { r0[0], r0[1], r0[2] };
+  double tL[3] = { t0[0], t0[1], t0[2] };
+  if (c1 > 1e-24)
+  {
+    const double rFactor = 2.0 * vtkMath::Dot(v1, r0) / c1;
+    const double tFactor = 2.0 * vtkMath::Dot(v1, t0) / c1;
+    for (int i = 0; i < 3; i++)
+    {
+      rL[i] -= rFactor * v1[i];
+      tL[i] -= tFactor * v1[i];
+    }
+  }
+  double v2[3] = { t1[0] - tL[0], t1[1] - tL[1], t1[2] - tL[2] };
+  const double c2 = vtkMath::Dot(v2, v2);
+  const double factor = (c2 > 1e-24) ? 2.0 * vtkMath::Dot(v2, rL) / c2 : 0.0;
+  for (int i = 0; i < 3; i++)
+  {
+    r1[i] = rL[i] - factor * v2[i];
+  }
+  // Remove rounding drift.
+  const double along = vtkMath::Dot(r1, t1);
+  for (int i = 0; i < 3; i++)
+  {
+    r1[i] -= along * t1[i];
+  }
+  vtkMath::Normalize(r1);
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTubeSweep::SweepRings(vtkPoints * samples, vtkDataArray * radii,
+                                   const double * tangents, const double * normals, int numberOfSides,
+                                   vtkIdType firstSample, vtkIdType lastSample,
+                                   float * ringPoints, float * ringNormals, double * ringRadii)
+{
+  // Shared by all samples.
+  std::vector<double> cosines(numberOfSides);
+  std::vector<double> sines(numberOfSides);
+  for (int k = 0; k < numberOfSides; k++)
+  {
+    const double angle = 2.0 * vtkMath::Pi() * k / numberOfSides;
+    cosines[k] = std::cos(angle);
+    sines[k] = std::sin(angle);
+  }
+  vtkSMPTools::For(firstSample, lastSample + 1, [&](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType m = begin; m < end; m++)
+    {
+      double center[3] = { 0.0 };
+      samples->GetPoint(m, center);
+      const double radius = radii->GetComponent(m, 0);
+      const double * normal = normals + 3 * m;
+      double binormal[3] = { 0.0 };
+      vtkMath::Cross(tangents + 3 * m, normal, binormal);
+      for (int k = 0; k < numberOfSides; k++)
+      {
+        const vtkIdType id = m * numberOfSides + k;
+        for (int c = 0; c < 3; c++)
+        {
+          const double direction = cosines[k] * normal[c] + sines[k] * binormal[c];
+          ringPoints[3 * id + c] = (float) (center[c] + radius * direction);
+          if (ringNormals)
+          {
+            ringNormals[3 * id + c] = (float) direction;
+          }
+        }
+        if (ringRadii)
+        {
+          ringRadii[id] = radius;
+        }
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+void vtkShapeTubeSweep::BuildStrips(vtkIdType numberOfSamples, int numberOfSides, vtkCellArray * strips)
+{
+  // Strip k alternates sides k and k + 1 along the tube, as vtkTubeFilter.
+  const vtkIdType stripSize = 2 * numberOfSamples;
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(numberOfSides + 1);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(stripSize * numberOfSides);
+  vtkIdType * offsetValues = offsets->GetPointer(0);
+  vtkIdType * connectivityValues = connectivity->GetPointer(0);
+  for (int k = 0; k <= numberOfSides; k++)
+  {
+    offsetValues[k] = k * stripSize;
+  }
+  // Over all strip points : there are few sides and many samples.
+  vtkSMPTools::For(0, numberOfSides * numberOfSamples, [&](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      const vtkIdType k = i / numberOfSamples;
+      const vtkIdType m = i % numberOfSamples;
+      vtkIdType * stripPoint = connectivityValues + k * stripSize + 2 * m;
+      stripPoint[0] = m * numberOfSides + k;
+      stripPoint[1] = m * numberOfSides + (k + 1) % numberOfSides;
+    }
+  });
+  strips->SetData(offsets, connectivity);
+}
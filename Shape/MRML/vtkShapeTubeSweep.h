@@ -0,0 +1,87 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#ifndef __vtkshapetubesweep_h_
+#define __vtkshapetubesweep_h_
+
+#include "vtkSlicerShapeModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+
+class vtkCellArray;
+class vtkDataArray;
+class vtkPoints;
+
+/**
+ * Tube around a centerline, a single polyline through the input points in order,
+ * with the radius at each point in the active scalars or in a TubeRadius array.
+ *
+ * Replaces vtkTubeFilter : ring vertices and triangle strips are written in parallel
+ * with vtkSMPTools into preallocated arrays. Frames rotate as little as possible;
+ * tangents are computed in parallel, the frame propagation is sequential and cheap.
+ * The output has one strip per side along the tube, point normals and TubeRadius.
+ */
+class VTK_SLICER_SHAPE_MODULE_MRML_EXPORT vtkShapeTubeSweep : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkShapeTubeSweep *New();
+  vtkTypeMacro(vtkShapeTubeSweep, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  vtkSetClampMacro(NumberOfSides, int, 3, VTK_INT_MAX);
+  vtkGetMacro(NumberOfSides, int);
+
+#ifndef __VTK_WRAP__
+  // Kernels, also used by vtkShapeSegmentedTube. Arrays have 3 components per sample.
+  /// Unit tangents by central differences, in parallel.
+  static void ComputeTangents(vtkPoints * samples, double * tangents);
+  /// Rotation minimizing normals by double reflection, from an initial normal at sample 0.
+  static void ComputeNormals(vtkPoints * samples, const double * tangents, double * normals);
+  /// The world axis least aligned with the tangent, made orthogonal to it.
+  static void GetInitialNormal(const double * tangent, double * normal);
+  /// Next normal of a rotation minimizing frame : Wang et al., Computation of rotation
+  /// minimizing frames, ACM TOG 2008.
+  static void PropagateNormal(const double * x0, const double * t0, const double * r0,
+                              const double * x1, const double * t1, double * r1);
+  /// Ring vertices of samples first to last, in parallel. Output arrays hold numberOfSides
+  /// tuples per sample from sample 0; ringNormals and ringRadii may be nullptr.
+  static void SweepRings(vtkPoints * samples, vtkDataArray * radii,
+                         const double * tangents, const double * normals, int numberOfSides,
+                         vtkIdType firstSample, vtkIdType lastSample,
+                         float * ringPoints, float * ringNormals, double * ringRadii);
+  /// One strip per side for numberOfSamples rings, in parallel.
+  static void BuildStrips(vtkIdType numberOfSamples, int numberOfSides, vtkCellArray * strips);
+#endif
+
+protected:
+  vtkShapeTubeSweep();
+  ~vtkShapeTubeSweep() override;
+
+  int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) override;
+
+  int NumberOfSides { 20 };
+
+private:
+  vtkShapeTubeSweep(const vtkShapeTubeSweep&) = delete;
+  void operator=(const vtkShapeTubeSweep&) = delete;
+};
+
+#endif // __vtkshapetubesweep_h_
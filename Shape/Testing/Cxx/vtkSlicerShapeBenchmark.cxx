@@ -0,0 +1,234 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+/*
+ * Times the Shape representations and measurements on a generated scene.
+ *
+ * Arguments, all optional :
+ *  --shapes N      : N spheres, rings, disks and tubes (default 10).
+ *  --pairs M       : control point pairs per tube (default 10).
+ *  --views K       : slice views, there is always one 3D view (default 3).
+ *  --iterations I  : control point moves and slice steps (default 5).
+ *  --output file, --max-mean-ms T : see ExtraMarkupsBenchmarkFixture.
+ */
+
+// Shape includes
+#include "vtkMRMLMarkupsShapeDisplayNode.h"
+#include "vtkMRMLMarkupsShapeNode.h"
+#include "vtkMRMLMeasurementShape.h"
+#include "vtkSlicerShapeLogic.h"
+#include "vtkSlicerShapeWidget.h"
+
+// Extension testing includes
+#include "ExtraMarkupsBenchmarkFixture.h"
+
+// Markups includes
+#include <vtkSlicerMarkupsWidgetRepresentation.h>
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkDoubleArray.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct ShapeView
+{
+  vtkSmartPointer<vtkSlicerShapeWidget> Widget;
+  vtkMRMLMarkupsShapeNode * ShapeNode { nullptr };
+  vtkMRMLSliceNode * SliceNode { nullptr }; // nullptr in the 3D view
+};
+
+//----------------------------------------------------------------------------
+// Small back and forth moves, so that the scene stays the same over iterations.
+void MoveControlPoint(vtkMRMLMarkupsShapeNode * shapeNode, int iteration)
+{
+  double position[3] = { 0.0 };
+  shapeNode->GetNthControlPointPositionWorld(1, position);
+  position[0] += (iteration % 2 == 0) ? 0.1 : -0.1;
+  shapeNode->SetNthControlPointPositionWorld(1, position);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerShapeBenchmark(int argc, char * argv[])
+{
+  ExtraMarkupsBenchmarkFixture fixture("Shape",
+    { { "shapes", 10 }, { "pairs", 10 }, { "views", 3 }, { "iterations", 5 } });
+  if (!fixture.ParseArguments(argc, argv))
+  {
+    return EXIT_FAILURE;
+  }
+  const int numberOfShapes = fixture.GetParameter("shapes");
+  const int numberOfPairs = std::max(2, fixture.GetParameter("pairs"));
+  const int numberOfSliceViews = fixture.GetParameter("views");
+  const int numberOfIterations = fixture.GetParameter("iterations");
+  vtkMRMLScene * scene = fixture.Scene;
+  ExtraMarkupsBenchmarkResults& results = fixture.Results;
+
+  vtkNew<vtkSlicerShapeLogic> shapeLogic;
+  fixture.SetUpModuleLogic(shapeLogic);
+
+  // Spheres, rings and disks on a grid.
+  vtkNew<vtkDoubleArray> centers;
+  centers->SetNumberOfComponents(3);
+  // Radii have 2 components : spheres and rings use the first one, disks use both.
+  vtkNew<vtkDoubleArray> radii;
+  radii->SetNumberOfComponents(2);
+  vtkNew<vtkIntArray> shapeTypes;
+  for (int shapeName : { vtkMRMLMarkupsShapeNode::Sphere, vtkMRMLMarkupsShapeNode::Ring,
+                         vtkMRMLMarkupsShapeNode::Disk })
+  {
+    for (int i = 0; i < numberOfShapes; i++)
+    {
+      centers->InsertNextTuple3(30.0 * i, 30.0 * shapeName, 0.0);
+      radii->InsertNextTuple2(shapeName == vtkMRMLMarkupsShapeNode::Disk ? 5.0 : 10.0, 10.0);
+      shapeTypes->InsertNextValue(shapeName);
+    }
+  }
+  vtkNew<vtkCollection> shapeNodes;
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  shapeLogic->CreateShapes(centers, radii, nullptr, shapeTypes, shapeNodes);
+  timer->StopTimer();
+  results.Add("CreateShapes", "All", timer->GetElapsedTime());
+
+  // Helical tubes.
+  for (int i = 0; i < numberOfShapes; i++)
+  {
+    vtkMRMLMarkupsShapeNode * tubeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLMarkupsShapeNode"));
+    tubeNode->CreateDefaultDisplayNodes();
+    tubeNode->SetShapeName(vtkMRMLMarkupsShapeNode::Tube);
+    vtkNew<vtkPoints> centerline;
+    vtkNew<vtkDoubleArray> tubeRadii;
+    for (int j = 0; j < numberOfPairs; j++)
+    {
+      const double angle = 0.5 * j;
+      centerline->InsertNextPoint(30.0 * i + 10.0 * std::cos(angle), -60.0 + 10.0 * std::sin(angle), 5.0 * j);
+      tubeRadii->InsertNextValue(2.0 + std::sin(angle));
+    }
+    tubeNode->SetTubeProfile(centerline, tubeRadii);
+    shapeNodes->AddItem(tubeNode);
+  }
+
+  fixture.CreateViews(numberOfSliceViews);
+  const std::vector<vtkMRMLSliceNode*>& sliceNodes = fixture.SliceNodes;
+
+  // One widget per shape and view, without displayable managers : representations are updated here.
+  std::vector<ShapeView> shapeViews;
+  for (int i = 0; i < shapeNodes->GetNumberOfItems(); i++)
+  {
+    vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(shapeNodes->GetItemAsObject(i));
+    vtkMRMLMarkupsDisplayNode * displayNode = vtkMRMLMarkupsDisplayNode::SafeDownCast(shapeNode->GetDisplayNode());
+    for (int j = -1; j < numberOfSliceViews; j++)
+    {
+      ShapeView shapeView;
+      shapeView.Widget = vtkSmartPointer<vtkSlicerShapeWidget>::New();
+      shapeView.ShapeNode = shapeNode;
+      shapeView.SliceNode = (j >= 0) ? sliceNodes[j] : nullptr;
+      shapeView.Widget->CreateDefaultRepresentation(displayNode, fixture.GetViewNode(j), fixture.GetRenderer(j));
+      shapeViews.push_back(shapeView);
+    }
+  }
+
+  // Control point moves : representations and measurements.
+  for (int iteration = 0; iteration < numberOfIterations; iteration++)
+  {
+    for (int i = 0; i < shapeNodes->GetNumberOfItems(); i++)
+    {
+      MoveControlPoint(vtkMRMLMarkupsShapeNode::SafeDownCast(shapeNodes->GetItemAsObject(i)), iteration);
+    }
+    for (const ShapeView& shapeView : shapeViews)
+    {
+      const char * shape = vtkMRMLMarkupsShapeNode::GetShapeNameAsString(shapeView.ShapeNode->GetShapeName());
+      vtkSlicerMarkupsWidgetRepresentation * representation =
+        vtkSlicerMarkupsWidgetRepresentation::SafeDownCast(shapeView.Widget->GetRepresentation());
+      timer->StartTimer();
+      representation->UpdateFromMRML(shapeView.ShapeNode, vtkMRMLMarkupsNode::PointModifiedEvent);
+      timer->StopTimer();
+      results.Add(shapeView.SliceNode ? "UpdateFromMRML2D" : "UpdateFromMRML3D", shape, timer->GetElapsedTime());
+      // Display only update : the shape geometry is unchanged.
+      timer->StartTimer();
+      representation->UpdateFromMRML(shapeView.ShapeNode->GetDisplayNode(), vtkCommand::ModifiedEvent);
+      timer->StopTimer();
+      results.Add(shapeView.SliceNode ? "UpdateFromMRML2DUnchanged" : "UpdateFromMRML3DUnchanged",
+                  shape, timer->GetElapsedTime());
+    }
+    for (int i = 0; i < shapeNodes->GetNumberOfItems(); i++)
+    {
+      vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(shapeNodes->GetItemAsObject(i));
+      MoveControlPoint(shapeNode, iteration + 1);
+      for (int j = 0; j < shapeNode->GetNumberOfMeasurements(); j++)
+      {
+        vtkMRMLMeasurementShape * measurement = vtkMRMLMeasurementShape::SafeDownCast(shapeNode->GetNthMeasurement(j));
+        if (!measurement)
+        {
+          continue;
+        }
+        timer->StartTimer();
+        measurement->Compute();
+        timer->StopTimer();
+        results.Add("MeasurementCompute", vtkMRMLMarkupsShapeNode::GetShapeNameAsString(shapeNode->GetShapeName()),
+                    timer->GetElapsedTime());
+      }
+    }
+  }
+
+  // Slice scrolling : all 2D representations of a slice view are updated at each step.
+  for (vtkMRMLSliceNode * sliceNode : sliceNodes)
+  {
+    const double initialOffset = sliceNode->GetSliceOffset();
+    for (int iteration = 0; iteration < numberOfIterations; iteration++)
+    {
+      sliceNode->SetSliceOffset(initialOffset + iteration);
+      for (const ShapeView& shapeView : shapeViews)
+      {
+        if (shapeView.SliceNode != sliceNode)
+        {
+          continue;
+        }
+        vtkSlicerMarkupsWidgetRepresentation * representation =
+          vtkSlicerMarkupsWidgetRepresentation::SafeDownCast(shapeView.Widget->GetRepresentation());
+        timer->StartTimer();
+        representation->UpdateFromMRML(sliceNode, vtkCommand::ModifiedEvent);
+        timer->StopTimer();
+        results.Add("SliceScroll", vtkMRMLMarkupsShapeNode::GetShapeNameAsString(shapeView.ShapeNode->GetShapeName()),
+                    timer->GetElapsedTime());
+      }
+    }
+    sliceNode->SetSliceOffset(initialOffset);
+  }
+
+  return fixture.WriteResults();
+}
@@ -20,15 +20,22 @@
 
 #include "vtkSlicerShapeRepresentation2D.h"
 #include "vtkMRMLMarkupsShapeNode.h"
+#include "vtkShapeTimingCounters.h"
+#include "vtkSlicerShapeSpatialIndex.h"
 
 #include <vtkActor2D.h>
+#include <vtkCellArray.h>
 #include <vtkGlyphSource2D.h>
 #include <vtkPolyDataMapper2D.h>
 #include <vtkProperty2D.h>
 #include <vtkSampleImplicitFunctionFilter.h>
 #include <vtkPlane.h>
-#include <vtkTupleInterpolator.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkTransform.h>
+
+#include <algorithm>
+#include <cmath>
 
 // TODO: Fix opacity of shape and intersection actors in Projection mode.
 //------------------------------------------------------------------------------
@@ -45,9 +52,11 @@ vtkSlicerShapeRepresentation2D::vtkSlicerShapeRepresentation2D()
   this->WorldToSliceTransformer->SetInputConnection(this->SliceDistance->GetOutputPort());
   
   this->ShapeWorldToSliceTransformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  this->ShapeWorldToSliceTransformer->SetTransform(this->WorldToSliceTransform);
+  // A copy of WorldToSliceTransform, only modified if the slice moved.
+  this->ShapeWorldToSliceTransform = vtkSmartPointer<vtkTransform>::New();
+  this->ShapeWorldToSliceTransformer->SetTransform(this->ShapeWorldToSliceTransform);
   this->ShapeCutWorldToSliceTransformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  this->ShapeCutWorldToSliceTransformer->SetTransform(this->WorldToSliceTransform);
+  this->ShapeCutWorldToSliceTransformer->SetTransform(this->ShapeWorldToSliceTransform);
   
   this->MiddlePointSource = vtkSmartPointer<vtkGlyphSource2D>::New();
   this->MiddlePointSource->SetCenter(0.0, 0.0, 0.0);
@@ -57,13 +66,6 @@ vtkSlicerShapeRepresentation2D::vtkSlicerShapeRepresentation2D()
   this->MiddlePointActor = vtkSmartPointer<vtkActor2D>::New();
   this->MiddlePointActor->SetMapper(this->MiddlePointDataMapper);
   
-  this->DiskSource = vtkSmartPointer<vtkDiskSource>::New();
-  this->DiskSource->SetInputConnection(this->WorldToSliceTransformer->GetOutputPort());
-  this->RingSource = vtkSmartPointer<vtkDiskSource>::New();
-  this->RingSource->SetInputConnection(this->WorldToSliceTransformer->GetOutputPort());
-  this->SphereSource = vtkSmartPointer<vtkSphereSource>::New();
-  this->SphereSource->SetInputConnection(this->WorldToSliceTransformer->GetOutputPort());
-  
   this->RadiusSource = vtkSmartPointer<vtkLineSource>::New();
   this->RadiusSource->SetInputConnection(this->WorldToSliceTransformer->GetOutputPort());
   this->RadiusMapper = vtkSmartPointer<vtkPolyDataMapper2D>::New();
@@ -74,8 +76,8 @@ vtkSlicerShapeRepresentation2D::vtkSlicerShapeRepresentation2D()
   this->RadiusActor->SetProperty(this->GetControlPointsPipeline(Unselected)->Property);
   
   this->ShapeMapper = vtkSmartPointer<vtkPolyDataMapper2D>::New();
-  //this->DiskMapper->SetInputConnection(this->DiskSource->GetOutputPort());
-  //this->DiskMapper->SetLookupTable(this->LineColorMap);
+  this->SliceProjection = vtkSmartPointer<vtkPolyData>::New();
+  this->ShapeMapper->SetInputData(this->SliceProjection);
   this->ShapeMapper->SetScalarVisibility(true);
   this->ShapeProperty = vtkSmartPointer<vtkProperty2D>::New();
   this->ShapeProperty->DeepCopy(this->GetControlPointsPipeline(Unselected)->Property);
@@ -83,30 +85,33 @@ vtkSlicerShapeRepresentation2D::vtkSlicerShapeRepresentation2D()
   this->ShapeActor->SetMapper(this->ShapeMapper);
   this->ShapeActor->SetProperty(this->ShapeProperty);
   
-  this->Spline = vtkSmartPointer<vtkParametricSpline>::New();
-  vtkNew<vtkPoints> points;
-  const double point[3] = { 0.0 };
-  points->InsertNextPoint(point);
-  this->Spline->SetPoints(points);
-  this->SplineFunctionSource = vtkSmartPointer<vtkParametricFunctionSource>::New();
-  this->SplineFunctionSource->SetParametricFunction(this->Spline);
-  this->Tube = vtkSmartPointer<vtkTubeFilter>::New();
-  this->Tube->SetNumberOfSides(20);
-  this->Tube->SetVaryRadiusToVaryRadiusByAbsoluteScalar();
-  this->Tube->SetInputConnection(this->SplineFunctionSource->GetOutputPort());
-  
   this->WorldPlane = vtkSmartPointer<vtkPlane>::New();
   this->WorldCutter = vtkSmartPointer<vtkCutter>::New();
-  //this->SliceViewCutter->SetInputConnection(this->DiskSource->GetOutputPort());
   this->WorldCutter->SetCutFunction(this->WorldPlane);
+  this->SliceIntersection = vtkSmartPointer<vtkPolyData>::New();
+  this->ShapeCutWorldToSliceTransformer->SetInputConnection(this->WorldCutter->GetOutputPort());
   this->WorldCutMapper = vtkSmartPointer<vtkPolyDataMapper2D>::New();
-  this->WorldCutMapper->SetInputConnection(this->WorldCutter->GetOutputPort());
+  this->WorldCutMapper->SetInputConnection(this->ShapeCutWorldToSliceTransformer->GetOutputPort());
   this->WorldCutActor = vtkSmartPointer<vtkActor2D>::New();
   this->WorldCutActor->SetMapper(this->WorldCutMapper);
 }
 
 //------------------------------------------------------------------------------
-vtkSlicerShapeRepresentation2D::~vtkSlicerShapeRepresentation2D() = default;
+vtkSlicerShapeRepresentation2D::~vtkSlicerShapeRepresentation2D()
+{
+  vtkSlicerShapeSpatialIndex::RemoveViewShape(this->SpatialIndexViewNode, this);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::UpdateSpatialIndex(vtkMRMLMarkupsShapeNode * shapeNode, bool indexed)
+{
+  if (this->SpatialIndexViewNode != this->GetViewNode())
+  {
+    vtkSlicerShapeSpatialIndex::RemoveViewShape(this->SpatialIndexViewNode, this);
+    this->SpatialIndexViewNode = this->GetViewNode();
+  }
+  vtkSlicerShapeSpatialIndex::UpdateViewShape(this->SpatialIndexViewNode, this, shapeNode, indexed);
+}
 
 //------------------------------------------------------------------------------
 void vtkSlicerShapeRepresentation2D::PrintSelf(ostream& os, vtkIndent indent)
@@ -123,11 +128,35 @@ void vtkSlicerShapeRepresentation2D::UpdateFromMRML(vtkMRMLNode* caller, unsigne
   vtkMRMLMarkupsShapeNode* shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->GetMarkupsNode());
   if (!shapeNode || !this->IsDisplayable())
   {
+    this->UpdateSpatialIndex(shapeNode, false);
     this->VisibilityOff();
     return;
   }
 
   this->VisibilityOn();
+  vtkShapeTimingCounters::ScopedTimer timer("UpdateFromMRML2D", shapeNode->GetShapeName());
+  // Projections of a sphere set are drawn away from their spheres.
+  this->UpdateSpatialIndex(shapeNode, !(shapeNode->GetShapeName() == vtkMRMLMarkupsShapeNode::Sphere
+                                        && shapeNode->GetSphereSet()
+                                        && shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Projection));
+  
+  // Nothing is cut, transformed or mapped for shapes away from the slice.
+  if (!this->IsShapeNearSlice(shapeNode))
+  {
+    this->ShapeActor->SetVisibility(false);
+    this->MiddlePointActor->SetVisibility(false);
+    this->RadiusActor->SetVisibility(false);
+    this->TextActor->SetVisibility(false);
+    this->WorldCutActor->SetVisibility(false);
+    return;
+  }
+  
+  // Generated once by the node for all views at the same resolution.
+  this->ViewResolution = shapeNode->GetViewResolution(this->ViewScaleFactorMmPerPixel);
+  shapeNode->UpdateShapeWorld(this->ViewResolution);
+  this->ShapeWorldToSliceTransformer->SetInputConnection(shapeNode->GetShapeWorldConnection(this->ViewResolution));
+  this->WorldCutter->SetInputConnection(shapeNode->GetShapeWorldConnection(this->ViewResolution));
+  this->UpdateShapeWorldToSliceTransform();
 
   this->MiddlePointActor->SetVisibility(shapeNode->GetNumberOfDefinedControlPoints(true) >= 2);
   // Hide the middle point actor if it doesn't intersect the current slice
@@ -155,7 +184,14 @@ void vtkSlicerShapeRepresentation2D::UpdateFromMRML(vtkMRMLNode* caller, unsigne
   switch (shapeNode->GetShapeName())
   {
     case vtkMRMLMarkupsShapeNode::Sphere :
-      this->UpdateSphereFromMRML(caller, event, callData);
+      if (shapeNode->GetSphereSet())
+      {
+        this->UpdateSphereSetFromMRML(caller, event, callData);
+      }
+      else
+      {
+        this->UpdateSphereFromMRML(caller, event, callData);
+      }
       break;
     case vtkMRMLMarkupsShapeNode::Ring :
       this->UpdateRingFromMRML(caller, event, callData);
@@ -177,13 +213,16 @@ void vtkSlicerShapeRepresentation2D::SetMarkupsNode(vtkMRMLMarkupsNode *markupsN
 {
   if (this->MarkupsNode != markupsNode)
   {
+    vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(markupsNode);
     if (markupsNode)
     {
       this->SliceDistance->SetInputConnection(markupsNode->GetCurveWorldConnection());
     }
-    else
+    // Connected to the node's geometry in UpdateFromMRML.
+    if (!shapeNode)
     {
-      //this->SliceDistance->SetInputData(this->RingSource->GetOutput());
+      this->ShapeWorldToSliceTransformer->RemoveAllInputConnections(0);
+      this->WorldCutter->RemoveAllInputConnections(0);
     }
   }
   this->Superclass::SetMarkupsNode(markupsNode);
@@ -340,6 +379,493 @@ vtkTypeBool vtkSlicerShapeRepresentation2D::HasTranslucentPolygonalGeometry()
   return false;
 }
 
+//-----------------------------------------------------------------------------
+bool vtkSlicerShapeRepresentation2D::IsShapeNearSlice(vtkMRMLMarkupsShapeNode * shapeNode)
+{
+  // Projections are drawn whatever the slice.
+  if (shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Projection)
+  {
+    return true;
+  }
+  double center[3] = { 0.0 };
+  double radius = 0.0;
+  // Shapes being placed are handled by the shape specific updates.
+  if (!shapeNode->GetShapeWorldBoundingSphere(center, radius))
+  {
+    return true;
+  }
+  vtkMRMLSliceNode * sliceNode = this->GetSliceNode();
+  vtkMatrix4x4 * sliceToRAS = sliceNode->GetSliceToRAS();
+  double normal[3] = { 0.0 };
+  double relativeCenter[3] = { 0.0 };
+  for (int i = 0; i < 3; i++)
+  {
+    normal[i] = sliceToRAS->GetElement(i, 2);
+    relativeCenter[i] = center[i] - sliceToRAS->GetElement(i, 3);
+  }
+  vtkMath::Normalize(normal);
+  // Same slab as IsRepresentationIntersectingSlice() : the control points are inside
+  // the bounding sphere, they would not intersect the slice either.
+  const double sliceNormalXY[4] = { 0.0, 0.0, 1.0, 0.0 };
+  double sliceNormalWorld[4] = { 0.0 };
+  sliceNode->GetXYToRAS()->MultiplyPoint(sliceNormalXY, sliceNormalWorld);
+  const double halfThickness = vtkMath::Norm(sliceNormalWorld) / 2.0;
+  return std::abs(vtkMath::Dot(relativeCenter, normal)) <= radius + halfThickness;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::UpdateShapeWorldToSliceTransform()
+{
+  // WorldToSliceTransform is reset on each update; keep filters up to date while the slice does not change.
+  vtkMatrix4x4 * worldToSlice = this->WorldToSliceTransform->GetMatrix();
+  vtkMatrix4x4 * shapeWorldToSlice = this->ShapeWorldToSliceTransform->GetMatrix();
+  for (int i = 0; i < 4; i++)
+  {
+    for (int j = 0; j < 4; j++)
+    {
+      if (worldToSlice->GetElement(i, j) != shapeWorldToSlice->GetElement(i, j))
+      {
+        this->ShapeWorldToSliceTransform->SetMatrix(worldToSlice);
+        return;
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::UpdateShapeProjection()
+{
+  vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->GetMarkupsNode());
+  if (!shapeNode || shapeNode->GetDrawMode2D() != vtkMRMLMarkupsShapeNode::Projection)
+  {
+    return;
+  }
+  // Scrolling only changes the third row.
+  double orientation[8] = { 0.0 };
+  vtkMatrix4x4 * shapeWorldToSlice = this->ShapeWorldToSliceTransform->GetMatrix();
+  for (int j = 0; j < 4; j++)
+  {
+    orientation[j] = shapeWorldToSlice->GetElement(0, j);
+    orientation[4 + j] = shapeWorldToSlice->GetElement(1, j);
+  }
+  const vtkMTimeType shapeWorldVersion = shapeNode->GetShapeWorldVersion(this->ViewResolution);
+  if (this->SliceProjectionShapeWorldVersion == shapeWorldVersion
+    && this->SliceProjectionViewScaleFactor == this->ViewScaleFactorMmPerPixel
+    && std::equal(orientation, orientation + 8, this->SliceProjectionOrientation))
+  {
+    return;
+  }
+  this->SliceProjectionShapeWorldVersion = shapeWorldVersion;
+  this->SliceProjectionViewScaleFactor = this->ViewScaleFactorMmPerPixel;
+  std::copy(orientation, orientation + 8, this->SliceProjectionOrientation);
+  
+  if (shapeNode->GetShapeName() == vtkMRMLMarkupsShapeNode::Tube)
+  {
+    vtkShapeTimingCounters::ScopedTimer timer("ShapeWorldToSliceTransformer", shapeNode->GetShapeName());
+    this->ShapeWorldToSliceTransformer->Update();
+    this->SliceProjection->ShallowCopy(this->ShapeWorldToSliceTransformer->GetOutput());
+  }
+  else
+  {
+    vtkShapeTimingCounters::ScopedTimer timer("AnalyticProjection", shapeNode->GetShapeName());
+    this->UpdateAnalyticProjection(shapeNode);
+  }
+  this->ShapeMapper->Update();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::UpdateAnalyticProjection(vtkMRMLMarkupsShapeNode * shapeNode)
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> cells;
+  this->SliceProjection->Initialize();
+  
+  double center[3] = { 0.0 };
+  double shapeNormal[3] = { 0.0 };
+  double radius = 0.0, innerRadius = 0.0;
+  if (!shapeNode->DescribeShapeWorld(center, shapeNormal, radius, innerRadius))
+  {
+    return;
+  }
+  // Axes of the shape circles in world coordinates.
+  double axis1[3] = { 0.0 };
+  double axis2[3] = { 0.0 };
+  vtkMatrix4x4 * sliceToRAS = this->GetSliceNode()->GetSliceToRAS();
+  double sliceNormal[3] = { 0.0 };
+  for (int i = 0; i < 3; i++)
+  {
+    axis1[i] = sliceToRAS->GetElement(i, 0);
+    axis2[i] = sliceToRAS->GetElement(i, 1);
+    sliceNormal[i] = sliceToRAS->GetElement(i, 2);
+  }
+  vtkMath::Normalize(axis1);
+  vtkMath::Normalize(axis2);
+  if (shapeNode->GetShapeName() != vtkMRMLMarkupsShapeNode::Sphere)
+  {
+    // A circle projects to an ellipse; its major axis is parallel to the slice.
+    vtkMath::Normalize(shapeNormal);
+    double majorAxis[3] = { 0.0 };
+    vtkMath::Cross(shapeNormal, sliceNormal, majorAxis);
+    if (vtkMath::Normalize(majorAxis) > 1e-6)
+    {
+      vtkMath::Cross(shapeNormal, majorAxis, axis2);
+      vtkMath::Normalize(axis2);
+      axis1[0] = majorAxis[0];
+      axis1[1] = majorAxis[1];
+      axis1[2] = majorAxis[2];
+    }
+  }
+  
+  // Same sides for inner and outer circles of a disk.
+  const int numberOfSides = this->GetSliceCircleNumberOfSides(radius);
+  const vtkIdType firstId = this->InsertSliceCirclePoints(center, axis1, axis2, radius, numberOfSides, points);
+  switch (shapeNode->GetShapeName())
+  {
+    case vtkMRMLMarkupsShapeNode::Sphere :
+    {
+      // The outline of a projected sphere is its great circle, filled as the projected mesh.
+      cells->InsertNextCell(numberOfSides);
+      for (int i = 0; i < numberOfSides; i++)
+      {
+        cells->InsertCellPoint(firstId + i);
+      }
+      this->SliceProjection->SetPolys(cells);
+      break;
+    }
+    case vtkMRMLMarkupsShapeNode::Ring :
+    {
+      cells->InsertNextCell(numberOfSides + 1);
+      for (int i = 0; i < numberOfSides; i++)
+      {
+        cells->InsertCellPoint(firstId + i);
+      }
+      cells->InsertCellPoint(firstId);
+      this->SliceProjection->SetLines(cells);
+      break;
+    }
+    case vtkMRMLMarkupsShapeNode::Disk :
+    {
+      if (innerRadius <= 0.0)
+      {
+        cells->InsertNextCell(numberOfSides);
+        for (int i = 0; i < numberOfSides; i++)
+        {
+          cells->InsertCellPoint(firstId + i);
+        }
+        this->SliceProjection->SetPolys(cells);
+        break;
+      }
+      // Annulus between the inner and outer ellipses.
+      const vtkIdType innerFirstId = this->InsertSliceCirclePoints(center, axis1, axis2, innerRadius,
+                                                                   numberOfSides, points);
+      cells->InsertNextCell(2 * (numberOfSides + 1));
+      for (int i = 0; i <= numberOfSides; i++)
+      {
+        cells->InsertCellPoint(firstId + (i % numberOfSides));
+        cells->InsertCellPoint(innerFirstId + (i % numberOfSides));
+      }
+      this->SliceProjection->SetStrips(cells);
+      break;
+    }
+    default :
+      break;
+  };
+  this->SliceProjection->SetPoints(points);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::UpdateShapeIntersection()
+{
+  double origin[3] = { 0.0 };
+  double normal[3] = { 0.0 };
+  vtkMatrix4x4 * sliceToRAS = this->GetSliceNode()->GetSliceToRAS();
+  for (int i = 0; i < 3; i++)
+  {
+    origin[i] = sliceToRAS->GetElement(i, 3);
+    normal[i] = sliceToRAS->GetElement(i, 2);
+  }
+  this->WorldPlane->SetOrigin(origin);
+  this->WorldPlane->SetNormal(normal);
+  
+  vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->GetMarkupsNode());
+  if (shapeNode && shapeNode->GetShapeName() != vtkMRMLMarkupsShapeNode::Tube)
+  {
+    vtkShapeTimingCounters::ScopedTimer timer("AnalyticIntersection", shapeNode->GetShapeName());
+    this->UpdateAnalyticIntersection(shapeNode, origin, normal);
+    this->WorldCutMapper->SetInputData(this->SliceIntersection);
+  }
+  else
+  {
+    vtkShapeTimingCounters::ScopedTimer timer("WorldCutter", shapeNode ? shapeNode->GetShapeName() : -1);
+    this->WorldCutMapper->SetInputConnection(this->ShapeCutWorldToSliceTransformer->GetOutputPort());
+    this->ShapeCutWorldToSliceTransformer->Update();
+  }
+  this->WorldCutMapper->Update();
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::UpdateAnalyticIntersection(vtkMRMLMarkupsShapeNode * shapeNode,
+                                                                const double * sliceOrigin,
+                                                                const double * sliceNormal)
+{
+  // Nothing to do if neither the shape, the slice nor the zoom factor changed.
+  const vtkMTimeType shapeWorldVersion = shapeNode->GetShapeWorldVersion(this->ViewResolution);
+  if (this->SliceIntersectionShapeWorldVersion == shapeWorldVersion
+    && this->SliceIntersectionTransformTime == this->ShapeWorldToSliceTransform->GetMTime()
+    && this->SliceIntersectionViewScaleFactor == this->ViewScaleFactorMmPerPixel
+    && this->SliceIntersectionDrawMode == shapeNode->GetDrawMode2D())
+  {
+    return;
+  }
+  this->SliceIntersectionShapeWorldVersion = shapeWorldVersion;
+  this->SliceIntersectionTransformTime = this->ShapeWorldToSliceTransform->GetMTime();
+  this->SliceIntersectionViewScaleFactor = this->ViewScaleFactorMmPerPixel;
+  this->SliceIntersectionDrawMode = shapeNode->GetDrawMode2D();
+  
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> lines;
+  this->SliceIntersection->Initialize();
+  
+  // In-plane axes of the slice.
+  double normal[3] = { sliceNormal[0], sliceNormal[1], sliceNormal[2] };
+  double sliceAxis1[3] = { 0.0 };
+  double sliceAxis2[3] = { 0.0 };
+  vtkMatrix4x4 * sliceToRAS = this->GetSliceNode()->GetSliceToRAS();
+  for (int i = 0; i < 3; i++)
+  {
+    sliceAxis1[i] = sliceToRAS->GetElement(i, 0);
+    sliceAxis2[i] = sliceToRAS->GetElement(i, 1);
+  }
+  vtkMath::Normalize(normal);
+  vtkMath::Normalize(sliceAxis1);
+  vtkMath::Normalize(sliceAxis2);
+  
+  if (shapeNode->GetShapeName() == vtkMRMLMarkupsShapeNode::Sphere && shapeNode->GetSphereSet())
+  {
+    this->AppendSphereSetCircles(shapeNode, sliceOrigin, normal, sliceAxis1, sliceAxis2, points, lines);
+    this->SliceIntersection->SetPoints(points);
+    this->SliceIntersection->SetLines(lines);
+    return;
+  }
+  
+  double center[3] = { 0.0 };
+  double shapeNormal[3] = { 0.0 };
+  double radius = 0.0, innerRadius = 0.0;
+  if (!shapeNode->DescribeShapeWorld(center, shapeNormal, radius, innerRadius))
+  {
+    return;
+  }
+  
+  const double relativeCenter[3] = { center[0] - sliceOrigin[0],
+                                     center[1] - sliceOrigin[1],
+                                     center[2] - sliceOrigin[2] };
+  // Signed distance of the shape center to the slice.
+  const double distance = vtkMath::Dot(relativeCenter, normal);
+  
+  if (shapeNode->GetShapeName() == vtkMRMLMarkupsShapeNode::Sphere)
+  {
+    // A circle, centered on the projection of the sphere center.
+    if (std::abs(distance) < radius)
+    {
+      const double circleCenter[3] = { center[0] - distance * normal[0],
+                                       center[1] - distance * normal[1],
+                                       center[2] - distance * normal[2] };
+      const double circleRadius = std::sqrt(radius * radius - distance * distance);
+      this->AppendSliceCircle(circleCenter, sliceAxis1, sliceAxis2, circleRadius, points, lines);
+    }
+  }
+  else
+  {
+    vtkMath::Normalize(shapeNormal);
+    // Intersection line of the shape plane with the slice.
+    double lineDirection[3] = { 0.0 };
+    vtkMath::Cross(shapeNormal, normal, lineDirection);
+    if (vtkMath::Normalize(lineDirection) < 1e-6)
+    {
+      // Parallel planes : the shape is seen in full if it lies in the slice.
+      if (std::abs(distance) < (this->ViewScaleFactorMmPerPixel / 2.0))
+      {
+        this->AppendSliceCircle(center, sliceAxis1, sliceAxis2, radius, points, lines);
+        if (innerRadius > 0.0)
+        {
+          this->AppendSliceCircle(center, sliceAxis1, sliceAxis2, innerRadius, points, lines);
+        }
+      }
+    }
+    else
+    {
+      // From center to the intersection line, in the shape plane.
+      double toLine[3] = { 0.0 };
+      vtkMath::Cross(lineDirection, shapeNormal, toLine);
+      const double offset = - distance / vtkMath::Dot(toLine, normal);
+      if (std::abs(offset) < radius)
+      {
+        const double foot[3] = { center[0] + offset * toLine[0],
+                                 center[1] + offset * toLine[1],
+                                 center[2] + offset * toLine[2] };
+        auto pointOnLine = [&foot, &lineDirection](double t, double * result)
+        {
+          result[0] = foot[0] + t * lineDirection[0];
+          result[1] = foot[1] + t * lineDirection[1];
+          result[2] = foot[2] + t * lineDirection[2];
+        };
+        const double halfChord = std::sqrt(radius * radius - offset * offset);
+        double first[3] = { 0.0 };
+        double last[3] = { 0.0 };
+        pointOnLine(- halfChord, first);
+        pointOnLine(halfChord, last);
+        if (shapeNode->GetShapeName() == vtkMRMLMarkupsShapeNode::Ring)
+        {
+          // Two points.
+          this->AppendSliceMarker(first, points, lines);
+          this->AppendSliceMarker(last, points, lines);
+        }
+        else if (std::abs(offset) < innerRadius)
+        {
+          // Two segments, the hole is between them.
+          const double innerHalfChord = std::sqrt(innerRadius * innerRadius - offset * offset);
+          double innerFirst[3] = { 0.0 };
+          double innerLast[3] = { 0.0 };
+          pointOnLine(- innerHalfChord, innerFirst);
+          pointOnLine(innerHalfChord, innerLast);
+          this->AppendSliceSegment(first, innerFirst, points, lines);
+          this->AppendSliceSegment(innerLast, last, points, lines);
+        }
+        else
+        {
+          // One segment.
+          this->AppendSliceSegment(first, last, points, lines);
+        }
+      }
+    }
+  }
+  
+  this->SliceIntersection->SetPoints(points);
+  this->SliceIntersection->SetLines(lines);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::AppendSphereSetCircles(vtkMRMLMarkupsShapeNode * shapeNode,
+                                                            const double * sliceOrigin, const double * sliceNormal,
+                                                            const double * sliceAxis1, const double * sliceAxis2,
+                                                            vtkPoints * points, vtkCellArray * lines)
+{
+  // The node's geometry has the sphere centers and radii, in world coordinates.
+  vtkPolyData * sphereSetWorld = shapeNode->GetShapeWorld(this->ViewResolution);
+  vtkDataArray * radii = sphereSetWorld->GetPointData()->GetArray("SphereRadius");
+  if (!radii)
+  {
+    return;
+  }
+  const bool projection = (shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Projection);
+  for (vtkIdType i = 0; i < sphereSetWorld->GetNumberOfPoints(); i++)
+  {
+    double center[3] = { 0.0 };
+    sphereSetWorld->GetPoint(i, center);
+    const double radius = radii->GetTuple1(i);
+    const double relativeCenter[3] = { center[0] - sliceOrigin[0],
+                                       center[1] - sliceOrigin[1],
+                                       center[2] - sliceOrigin[2] };
+    const double distance = vtkMath::Dot(relativeCenter, sliceNormal);
+    if (!projection && std::abs(distance) >= radius)
+    {
+      continue;
+    }
+    const double circleCenter[3] = { center[0] - distance * sliceNormal[0],
+                                     center[1] - distance * sliceNormal[1],
+                                     center[2] - distance * sliceNormal[2] };
+    // The outline of a sphere projected on the slice is its great circle.
+    const double circleRadius = projection ? radius : std::sqrt(radius * radius - distance * distance);
+    this->AppendSliceCircle(circleCenter, sliceAxis1, sliceAxis2, circleRadius, points, lines);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::AppendSliceCircle(const double * centerWorld,
+                                                       const double * axis1World, const double * axis2World,
+                                                       double radiusWorld, vtkPoints * points, vtkCellArray * lines)
+{
+  const int numberOfSides = this->GetSliceCircleNumberOfSides(radiusWorld);
+  const vtkIdType firstId = this->InsertSliceCirclePoints(centerWorld, axis1World, axis2World, radiusWorld,
+                                                          numberOfSides, points);
+  lines->InsertNextCell(numberOfSides + 1);
+  for (int i = 0; i < numberOfSides; i++)
+  {
+    lines->InsertCellPoint(firstId + i);
+  }
+  lines->InsertCellPoint(firstId);
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerShapeRepresentation2D::GetSliceCircleNumberOfSides(double radiusWorld)
+{
+  // Enough sides for a maximum deviation of a quarter of a pixel from the true circle.
+  const double maximumDeviation = 0.25;
+  const double radiusPixel = radiusWorld / std::max(this->ViewScaleFactorMmPerPixel, 1e-6);
+  int numberOfSides = 8;
+  if (radiusPixel > maximumDeviation)
+  {
+    const double sideAngle = 2.0 * std::acos(1.0 - maximumDeviation / radiusPixel);
+    numberOfSides = (int) std::ceil(2.0 * vtkMath::Pi() / sideAngle);
+  }
+  return std::min(std::max(numberOfSides, 8), 720);
+}
+
+//-----------------------------------------------------------------------------
+vtkIdType vtkSlicerShapeRepresentation2D::InsertSliceCirclePoints(const double * centerWorld,
+                                                                  const double * axis1World, const double * axis2World,
+                                                                  double radiusWorld, int numberOfSides,
+                                                                  vtkPoints * points)
+{
+  const vtkIdType firstId = points->GetNumberOfPoints();
+  for (int i = 0; i < numberOfSides; i++)
+  {
+    const double angle = 2.0 * vtkMath::Pi() * i / numberOfSides;
+    const double c = radiusWorld * std::cos(angle);
+    const double s = radiusWorld * std::sin(angle);
+    const double pointWorld[3] = { centerWorld[0] + c * axis1World[0] + s * axis2World[0],
+                                   centerWorld[1] + c * axis1World[1] + s * axis2World[1],
+                                   centerWorld[2] + c * axis1World[2] + s * axis2World[2] };
+    double pointSlice[3] = { 0.0 };
+    this->ShapeWorldToSliceTransform->TransformPoint(pointWorld, pointSlice);
+    points->InsertNextPoint(pointSlice);
+  }
+  return firstId;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::AppendSliceSegment(const double * p1World, const double * p2World,
+                                                        vtkPoints * points, vtkCellArray * lines)
+{
+  double p1Slice[3] = { 0.0 };
+  double p2Slice[3] = { 0.0 };
+  this->ShapeWorldToSliceTransform->TransformPoint(p1World, p1Slice);
+  this->ShapeWorldToSliceTransform->TransformPoint(p2World, p2Slice);
+  lines->InsertNextCell(2);
+  lines->InsertCellPoint(points->InsertNextPoint(p1Slice));
+  lines->InsertCellPoint(points->InsertNextPoint(p2Slice));
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::AppendSliceMarker(const double * pointWorld,
+                                                       vtkPoints * points, vtkCellArray * lines)
+{
+  // A small cross in pixels; a single point is hardly visible.
+  const double halfSize = 3.0;
+  double pointSlice[3] = { 0.0 };
+  this->ShapeWorldToSliceTransform->TransformPoint(pointWorld, pointSlice);
+  for (int axis = 0; axis < 2; axis++)
+  {
+    double p1[3] = { pointSlice[0], pointSlice[1], pointSlice[2] };
+    double p2[3] = { pointSlice[0], pointSlice[1], pointSlice[2] };
+    p1[axis] -= halfSize;
+    p2[axis] += halfSize;
+    lines->InsertNextCell(2);
+    lines->InsertCellPoint(points->InsertNextPoint(p1));
+    lines->InsertCellPoint(points->InsertNextPoint(p2));
+  }
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlicerShapeRepresentation2D::UpdateDiskFromMRML(vtkMRMLNode* caller, unsigned long event,
                                                         void* callData)
@@ -382,39 +908,21 @@ void vtkSlicerShapeRepresentation2D::UpdateDiskFromMRML(vtkMRMLNode* caller, uns
     shapeNode->GetNthControlPointPositionWorld(0, p1World);
     shapeNode->GetNthControlPointPositionWorld(1, p2World);
     shapeNode->GetNthControlPointPositionWorld(2, p3World);
-          
-    // Calculate normal relative to p1World
-    double normalWorld[3] = { 0.0 };
-    double rp2World[3] = { 0.0 };
-    double rp3World[3] = { 0.0 };
-    vtkMath::Subtract(p2World, p1World, rp2World);
-    vtkMath::Subtract(p3World, p1World, rp3World);
-    vtkMath::Cross(rp2World, rp3World, normalWorld);
-          
-    // Calculate inner and outer radii. Account for point proximities to center.
-    double innerRadius = 0.0;
-    double outerRadius = 0.0;
+    
+    // Account for point proximities to center.
     if (closestPoint[0] == p2World[0] && closestPoint[1] == p2World[1] && closestPoint[2] == p2World[2])
     {
-      innerRadius = std::sqrt(vtkMath::Distance2BetweenPoints(p1World, p2World));
-      outerRadius = std::sqrt(vtkMath::Distance2BetweenPoints(p1World, p3World));
       farthestDisplayPoint[0] = p3[0];
       farthestDisplayPoint[1] = p3[1];
       farthestDisplayPoint[2] = p3[2];
     }
     else
     {
-      innerRadius = std::sqrt(vtkMath::Distance2BetweenPoints(p1World, p3World));
-      outerRadius = std::sqrt(vtkMath::Distance2BetweenPoints(p1World, p2World));
       farthestDisplayPoint[0] = p2[0];
       farthestDisplayPoint[1] = p2[1];
       farthestDisplayPoint[2] = p2[2];
     }
             
-    this->DiskSource->SetCenter(p1World);
-    this->DiskSource->SetNormal(normalWorld);
-    this->DiskSource->SetOuterRadius(outerRadius);
-    this->DiskSource->SetInnerRadius(innerRadius);
     // Show projections on demand.
     this->WorldCutActor->SetVisibility(shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Intersection);
     this->ShapeActor->SetVisibility(shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Projection);
@@ -426,32 +934,8 @@ void vtkSlicerShapeRepresentation2D::UpdateDiskFromMRML(vtkMRMLNode* caller, uns
     this->WorldCutActor->SetVisibility(false);
   }
   
-  this->DiskSource->SetCircumferentialResolution((int) shapeNode->GetResolution());
-  this->DiskSource->Update();
-  
-  // Update shape and map from world to slice.
-  this->ShapeWorldToSliceTransformer->SetInputConnection(this->DiskSource->GetOutputPort());
-  this->ShapeWorldToSliceTransformer->Update();
-  this->ShapeMapper->SetInputConnection(this->ShapeWorldToSliceTransformer->GetOutputPort());
-  this->ShapeMapper->Update();
-  
-  // Update intersection and map from world to slice.
-  double origin[3] = { 0.0 };
-  double normal[3] = { 0.0 };
-  vtkMatrix4x4 * sliceToRAS = this->GetSliceNode()->GetSliceToRAS();
-  for (int i = 0; i < 4; i++)
-  {
-    origin[i] = sliceToRAS->GetElement(i, 3);
-    normal[i] = sliceToRAS->GetElement(i, 2);
-  }
-  this->WorldPlane->SetOrigin(origin);
-  this->WorldPlane->SetNormal(normal);
-  this->WorldCutter->SetInputConnection(this->DiskSource->GetOutputPort());
-  this->WorldCutter->Update();
-  this->ShapeCutWorldToSliceTransformer->SetInputConnection(this->WorldCutter->GetOutputPort());
-  this->ShapeCutWorldToSliceTransformer->Update();
-  this->WorldCutMapper->SetInputConnection(this->ShapeCutWorldToSliceTransformer->GetOutputPort());
-  this->WorldCutMapper->Update();
+  this->UpdateShapeProjection();
+  this->UpdateShapeIntersection();
   
   // Hide the disk actor if it doesn't intersect the current slice
   this->SliceDistance->Update();
@@ -489,8 +973,6 @@ void vtkSlicerShapeRepresentation2D::UpdateRingFromMRML(vtkMRMLNode* caller, uns
   this->TextActor->SetVisibility(visibility);
   this->WorldCutActor->SetVisibility(visibility);
   
-  this->ShapeMapper->SetInputConnection(this->RingSource->GetOutputPort());
-  
   if (shapeNode->GetNumberOfDefinedControlPoints(true) == 3)
   {
     // Display coordinates.
@@ -501,32 +983,9 @@ void vtkSlicerShapeRepresentation2D::UpdateRingFromMRML(vtkMRMLNode* caller, uns
     this->GetNthControlPointDisplayPosition(1, p2);
     this->GetNthControlPointDisplayPosition(2, p3);
     
-    // World coordinates.
-    double p1World[3] = { 0.0 };
-    double p2World[3] = { 0.0 };
-    double p3World[3] = { 0.0 };
-    shapeNode->GetNthControlPointPositionWorld(0, p1World);
-    shapeNode->GetNthControlPointPositionWorld(1, p2World);
-    shapeNode->GetNthControlPointPositionWorld(2, p3World);
-    
-    // Normal relative to p1
-    double normalWorld[3] = { 0.0 };
-    double rp2World[3] = { 0.0 };
-    double rp3World[3] = { 0.0 };
-    vtkMath::Subtract(p2World, p1World, rp2World);
-    vtkMath::Subtract(p3World, p1World, rp3World);
-    vtkMath::Cross(rp2World, rp3World, normalWorld);
-    
-    double lineLengthWorld = std::sqrt(vtkMath::Distance2BetweenPoints(p1World, p2World)); 
-          
     // Centered mode.
     if (shapeNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
-    {       
-      this->RingSource->SetCenter(p1World);
-      this->RingSource->SetNormal(normalWorld);
-      this->RingSource->SetOuterRadius(lineLengthWorld);
-      this->RingSource->SetInnerRadius((lineLengthWorld - this->ViewScaleFactorMmPerPixel) );
-      
+    {
       this->MiddlePointSource->SetCenter(p1[0], p1[1], 0.0);
       this->MiddlePointSource->Update();
       // The middle point's properties are distinct.
@@ -537,16 +996,6 @@ void vtkSlicerShapeRepresentation2D::UpdateRingFromMRML(vtkMRMLNode* caller, uns
     // Circumferential mode : center is half way between p1 and p2.
     else
     {
-      double radiusWorld = lineLengthWorld / 2.0;
-      double centerWorld[3] = { (p1World[0] + p2World[0]) / 2.0,
-                          (p1World[1] + p2World[1]) / 2.0,
-                          (p1World[2] + p2World[2]) / 2.0 };
-        
-      this->RingSource->SetCenter(centerWorld);
-      this->RingSource->SetNormal(normalWorld);
-      this->RingSource->SetOuterRadius(radiusWorld);
-      this->RingSource->SetInnerRadius(radiusWorld - this->ViewScaleFactorMmPerPixel);
-      
       double middlePointPos[2] = { (p1[0] + p2[0]) / 2.0, (p1[1] + p2[1]) / 2.0 };
       this->MiddlePointSource->SetCenter(middlePointPos[0], middlePointPos[1], 0.0);
       this->MiddlePointSource->Update();
@@ -559,33 +1008,6 @@ void vtkSlicerShapeRepresentation2D::UpdateRingFromMRML(vtkMRMLNode* caller, uns
     // Show the projection. SliceViewCutActor is also visible, but will blend with the projection. 
     this->ShapeActor->SetVisibility(shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Projection);
     
-    this->RingSource->SetCircumferentialResolution((int) shapeNode->GetResolution());
-    this->RingSource->Update();
-    
-    // Update shape and map from world to slice.
-    this->ShapeWorldToSliceTransformer->SetInputConnection(this->RingSource->GetOutputPort());
-    this->ShapeWorldToSliceTransformer->Update();
-    this->ShapeMapper->SetInputConnection(this->ShapeWorldToSliceTransformer->GetOutputPort());
-    this->ShapeMapper->Update();
-    
-    // Update intersection and map from world to slice.
-    double origin[3] = { 0.0 };
-    double normal[3] = { 0.0 };
-    vtkMatrix4x4 * sliceToRAS = this->GetSliceNode()->GetSliceToRAS();
-    for (int i = 0; i < 4; i++)
-    {
-      origin[i] = sliceToRAS->GetElement(i, 3);
-      normal[i] = sliceToRAS->GetElement(i, 2);
-    }
-    this->WorldPlane->SetOrigin(origin);
-    this->WorldPlane->SetNormal(normal);
-    this->WorldCutter->SetInputConnection(this->RingSource->GetOutputPort());
-    this->WorldCutter->Update();
-    this->ShapeCutWorldToSliceTransformer->SetInputConnection(this->WorldCutter->GetOutputPort());
-    this->ShapeCutWorldToSliceTransformer->Update();
-    this->WorldCutMapper->SetInputConnection(this->ShapeCutWorldToSliceTransformer->GetOutputPort());
-    this->WorldCutMapper->Update();
-    
     this->RadiusSource->SetPoint2(p2);
     this->RadiusSource->Update();
     this->TextActor->SetDisplayPosition(p3[0], p3[1]);
@@ -599,6 +1021,9 @@ void vtkSlicerShapeRepresentation2D::UpdateRingFromMRML(vtkMRMLNode* caller, uns
     this->WorldCutActor->SetVisibility(false);
   }
   
+  this->UpdateShapeProjection();
+  this->UpdateShapeIntersection();
+  
   // Hide actors if they don't intersect the current slice
   this->SliceDistance->Update();
   if (!Superclass::IsRepresentationIntersectingSlice(vtkPolyData::SafeDownCast(this->SliceDistance->GetOutput()), this->SliceDistance->GetScalarArrayName()))
@@ -629,9 +1054,6 @@ void vtkSlicerShapeRepresentation2D::UpdateSphereFromMRML(vtkMRMLNode* caller, u
   this->RadiusActor->SetVisibility(visibility);
   this->TextActor->SetVisibility(visibility);
   
-  this->ShapeMapper->SetInputConnection(this->SphereSource->GetOutputPort());
-  this->WorldCutter->SetInputConnection(this->SphereSource->GetOutputPort());
-  
   if (shapeNode->GetNumberOfDefinedControlPoints(true) == 2)
   {
     // Display coordinates.
@@ -640,20 +1062,9 @@ void vtkSlicerShapeRepresentation2D::UpdateSphereFromMRML(vtkMRMLNode* caller, u
     this->GetNthControlPointDisplayPosition(0, p1);
     this->GetNthControlPointDisplayPosition(1, p2);
     
-    // World coordinates.
-    double p1World[3] = { 0.0 };
-    double p2World[3] = { 0.0 };
-    shapeNode->GetNthControlPointPositionWorld(0, p1World);
-    shapeNode->GetNthControlPointPositionWorld(1, p2World);
-      
-    double lineLengthWorld = std::sqrt(vtkMath::Distance2BetweenPoints(p1World, p2World));
-    
     // Centered mode.
     if (shapeNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
-    { 
-      this->SphereSource->SetCenter(p1World);
-      this->SphereSource->SetRadius(lineLengthWorld);
-      
+    {
       this->MiddlePointSource->SetCenter(p1[0], p1[1], 0.0);
       this->MiddlePointSource->Update();
       // The middle point's properties are distinct.
@@ -664,14 +1075,6 @@ void vtkSlicerShapeRepresentation2D::UpdateSphereFromMRML(vtkMRMLNode* caller, u
     // Circumferential mode : center is half way between p1 and p2.
     else
     {
-      double radiusWorld = lineLengthWorld / 2.0;
-      double centerWorld[3] = { (p1World[0] + p2World[0]) / 2.0,
-                          (p1World[1] + p2World[1]) / 2.0,
-                          (p1World[2] + p2World[2]) / 2.0 };
-        
-      this->SphereSource->SetCenter(centerWorld);
-      this->SphereSource->SetRadius(radiusWorld);
-      
       double middlePointPos[2] = { (p1[0] + p2[0]) / 2.0, (p1[1] + p2[1]) / 2.0 };
       this->MiddlePointSource->SetCenter(middlePointPos[0], middlePointPos[1], 0.0);
       this->MiddlePointSource->Update();
@@ -683,34 +1086,6 @@ void vtkSlicerShapeRepresentation2D::UpdateSphereFromMRML(vtkMRMLNode* caller, u
     this->RadiusActor->SetVisibility(shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Intersection);
     this->WorldCutActor->SetVisibility(shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Intersection);
     
-    this->SphereSource->SetPhiResolution(shapeNode->GetResolution());
-    this->SphereSource->SetThetaResolution(shapeNode->GetResolution());
-    this->SphereSource->Update();
-    
-    // Update shape and map from world to slice.
-    this->ShapeWorldToSliceTransformer->SetInputConnection(this->SphereSource->GetOutputPort());
-    this->ShapeWorldToSliceTransformer->Update();
-    this->ShapeMapper->SetInputConnection(this->ShapeWorldToSliceTransformer->GetOutputPort());
-    this->ShapeMapper->Update();
-    
-    // Update intersection and map from world to slice.
-    double origin[3] = { 0.0 };
-    double normal[3] = { 0.0 };
-    vtkMatrix4x4 * sliceToRAS = this->GetSliceNode()->GetSliceToRAS();
-    for (int i = 0; i < 4; i++)
-    {
-      origin[i] = sliceToRAS->GetElement(i, 3);
-      normal[i] = sliceToRAS->GetElement(i, 2);
-    }
-    this->WorldPlane->SetOrigin(origin);
-    this->WorldPlane->SetNormal(normal);
-    this->WorldCutter->SetInputConnection(this->SphereSource->GetOutputPort());
-    this->WorldCutter->Update();
-    this->ShapeCutWorldToSliceTransformer->SetInputConnection(this->WorldCutter->GetOutputPort());
-    this->ShapeCutWorldToSliceTransformer->Update();
-    this->WorldCutMapper->SetInputConnection(this->ShapeCutWorldToSliceTransformer->GetOutputPort());
-    this->WorldCutMapper->Update();
-    
     this->RadiusSource->SetPoint2(p2);
     this->RadiusSource->Update();
     this->TextActor->SetDisplayPosition(p2[0], p2[1]);
@@ -724,6 +1099,9 @@ void vtkSlicerShapeRepresentation2D::UpdateSphereFromMRML(vtkMRMLNode* caller, u
     this->TextActor->SetVisibility(false);
   }
   
+  this->UpdateShapeProjection();
+  this->UpdateShapeIntersection();
+  
   // Hide actors if they don't intersect the current slice
   this->SliceDistance->Update();
   if (!this->IsRepresentationIntersectingSlice(vtkPolyData::SafeDownCast(this->SliceDistance->GetOutput()), this->SliceDistance->GetScalarArrayName()))
@@ -751,6 +1129,38 @@ void vtkSlicerShapeRepresentation2D::UpdateSphereFromMRML(vtkMRMLNode* caller, u
   this->RadiusActor->SetProperty(this->ShapeProperty);
 }
 
+//-----------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation2D::UpdateSphereSetFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData)
+{
+  vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->GetMarkupsNode());
+  
+  // Both draw modes are closed form circles in SliceIntersection.
+  this->ShapeActor->SetVisibility(false);
+  this->MiddlePointActor->SetVisibility(false);
+  this->RadiusActor->SetVisibility(false);
+  
+  this->UpdateShapeIntersection();
+  const bool visibility = this->SliceIntersection->GetNumberOfPoints() > 0;
+  this->WorldCutActor->SetVisibility(visibility);
+  this->TextActor->SetVisibility(visibility);
+  if (!visibility)
+  {
+    return;
+  }
+  
+  double p1[3] = { 0.0 };
+  this->GetNthControlPointDisplayPosition(0, p1);
+  this->TextActor->SetDisplayPosition(p1[0], p1[1]);
+  
+  int controlPointType = this->GetAllControlPointsSelected() ? Selected : Unselected;
+  this->TextActor->SetTextProperty(this->GetControlPointsPipeline(controlPointType)->TextProperty);
+  double opacity = this->MarkupsDisplayNode->GetOpacity();
+  double fillOpacity = opacity * this->MarkupsDisplayNode->GetFillOpacity();
+  this->ShapeProperty->DeepCopy(this->GetControlPointsPipeline(controlPointType)->Property);
+  this->ShapeProperty->SetOpacity(fillOpacity);
+  this->WorldCutActor->SetProperty(this->ShapeProperty);
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlicerShapeRepresentation2D::UpdateTubeFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData)
 {
@@ -766,89 +1176,12 @@ void vtkSlicerShapeRepresentation2D::UpdateTubeFromMRML(vtkMRMLNode* caller, uns
     return;
   }
   
-  this->ShapeMapper->SetInputConnection(this->Tube->GetOutputPort());
-  this->WorldCutter->SetInputConnection(this->Tube->GetOutputPort());
-  
   this->TextActor->SetVisibility(true);
-  
-  vtkNew<vtkPoints> splinePoints;
-  vtkNew<vtkTupleInterpolator> interpolatedRadius;
-  interpolatedRadius->SetInterpolationTypeToLinear();
-  interpolatedRadius->SetNumberOfComponents(1);
-  int interpolatorIndex = 0;
-  for (int i = 0; i < shapeNode->GetNumberOfControlPoints(); i = i + 2)
-  {
-    double middlePoint[3] = { 0.0 };
-    double p1[3] = { 0.0 };
-    double p2[3] = { 0.0 };
-    shapeNode->GetNthControlPointPositionWorld(i, p1);
-    shapeNode->GetNthControlPointPositionWorld(i + 1, p2);
-    middlePoint[0] = (p1[0] + p2[0]) / 2.0;
-    middlePoint[1] = (p1[1] + p2[1]) / 2.0;
-    middlePoint[2] = (p1[2] + p2[2]) / 2.0;
-    splinePoints->InsertNextPoint(middlePoint);
-    
-    double radius = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2)) / 2.0;
-    interpolatedRadius->AddTuple(interpolatorIndex, &radius);
-    //interpolatedRadius->AddTuple(i + 1, &radius);
-    interpolatorIndex++;
-  }
-  int numberOfPoints = splinePoints->GetNumberOfPoints();
-  
-  this->Spline->SetPoints(splinePoints);
-  this->SplineFunctionSource->SetUResolution(100 * numberOfPoints);
-  this->SplineFunctionSource->SetVResolution(100 * numberOfPoints);
-  this->SplineFunctionSource->SetWResolution(100 * numberOfPoints);
-  this->SplineFunctionSource->Update();
-  vtkPolyData * splinePolyData = this->SplineFunctionSource->GetOutput();
-  numberOfPoints = splinePolyData->GetNumberOfPoints();
-  
-  // https://kitware.github.io/vtk-examples/site/Cxx/VisualizationAlgorithms/TubesFromSplines/
-  vtkSmartPointer<vtkDoubleArray> tubeRadius = vtkSmartPointer<vtkDoubleArray>::New();
-  tubeRadius->SetNumberOfTuples(numberOfPoints);
-  tubeRadius->SetName("TubeRadius");
-  double tMin = interpolatedRadius->GetMinimumT();
-  double tMax = interpolatedRadius->GetMaximumT();
-  double r;
-  for (unsigned int i = 0; i < numberOfPoints; ++i)
-  {
-    double t = (tMax - tMin) / (numberOfPoints - 1) * i + tMin;
-    interpolatedRadius->InterpolateTuple(t, &r);
-    tubeRadius->SetTuple1(i, r);
-  }
-  
-  splinePolyData->GetPointData()->AddArray(tubeRadius);
-  splinePolyData->GetPointData()->SetActiveScalars("TubeRadius");
-  
-  this->Tube->SetNumberOfSides(shapeNode->GetResolution());
-  this->Tube->Update();
-  
   this->ShapeActor->SetVisibility(shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Projection);
   this->WorldCutActor->SetVisibility(shapeNode->GetDrawMode2D() == vtkMRMLMarkupsShapeNode::Intersection);
   
-  // Update shape and map from world to slice.
-  this->ShapeWorldToSliceTransformer->SetInputConnection(this->Tube->GetOutputPort());
-  this->ShapeWorldToSliceTransformer->Update();
-  this->ShapeMapper->SetInputConnection(this->ShapeWorldToSliceTransformer->GetOutputPort());
-  this->ShapeMapper->Update();
-  
-  // Update intersection and map from world to slice.
-  double origin[3] = { 0.0 };
-  double normal[3] = { 0.0 };
-  vtkMatrix4x4 * sliceToRAS = this->GetSliceNode()->GetSliceToRAS();
-  for (int i = 0; i < 4; i++)
-  {
-    origin[i] = sliceToRAS->GetElement(i, 3);
-    normal[i] = sliceToRAS->GetElement(i, 2);
-  }
-  this->WorldPlane->SetOrigin(origin);
-  this->WorldPlane->SetNormal(normal);
-  this->WorldCutter->SetInputConnection(this->Tube->GetOutputPort());
-  this->WorldCutter->Update();
-  this->ShapeCutWorldToSliceTransformer->SetInputConnection(this->WorldCutter->GetOutputPort());
-  this->ShapeCutWorldToSliceTransformer->Update();
-  this->WorldCutMapper->SetInputConnection(this->ShapeCutWorldToSliceTransformer->GetOutputPort());
-  this->WorldCutMapper->Update();
+  this->UpdateShapeProjection();
+  this->UpdateShapeIntersection();
   
   double p1[3] = { 0.0 };
   this->GetNthControlPointDisplayPosition(0, p1);
@@ -47,19 +47,18 @@
 
 // VTK includes
 #include <vtkSmartPointer.h>
-#include <vtkDiskSource.h>
 #include <vtkLineSource.h>
-#include <vtkSphereSource.h>
 #include <vtkSampleImplicitFunctionFilter.h>
 #include <vtkCutter.h>
-#include <vtkTubeFilter.h>
-#include <vtkParametricSpline.h>
-#include <vtkParametricFunctionSource.h>
 
 //------------------------------------------------------------------------------
 class vtkGlyphSource2D;
 class vtkPolyDataMapper2D;
 class vtkActor2D;
+class vtkCellArray;
+class vtkMRMLMarkupsShapeNode;
+class vtkPoints;
+class vtkTransform;
 
 /**
  * @class   vtkSlicerShapeRepresentation2D
@@ -98,7 +97,40 @@ protected:
   void UpdateDiskFromMRML(vtkMRMLNode* caller, unsigned long event, void *callData=nullptr);
   void UpdateRingFromMRML(vtkMRMLNode* caller, unsigned long event, void *callData=nullptr);
   void UpdateSphereFromMRML(vtkMRMLNode* caller, unsigned long event, void *callData=nullptr);
+  void UpdateSphereSetFromMRML(vtkMRMLNode* caller, unsigned long event, void *callData=nullptr);
   void UpdateTubeFromMRML(vtkMRMLNode* caller, unsigned long event, void *callData=nullptr);
+  // Whether the node's bounding sphere reaches the slice, within half the slice thickness;
+  // always true in Projection mode.
+  bool IsShapeNearSlice(vtkMRMLMarkupsShapeNode * shapeNode);
+  // Copy WorldToSliceTransform to ShapeWorldToSliceTransform if it changed.
+  void UpdateShapeWorldToSliceTransform();
+  // Map the node's shape geometry to the slice view, in Projection mode only.
+  // Sphere, Ring and Disk are projected in closed form, Tube by transforming its mesh.
+  // It is done again only if the shape, the slice orientation or the zoom factor changed :
+  // slice coordinates in the slice plane do not depend on the slice offset.
+  void UpdateShapeProjection();
+  // Closed form projection of Sphere, Ring and Disk.
+  void UpdateAnalyticProjection(vtkMRMLMarkupsShapeNode * shapeNode);
+  // Cut the node's shape geometry with the slice plane and map the result to the slice view.
+  void UpdateShapeIntersection();
+  // Closed form intersection of Sphere, Ring and Disk with the slice plane, in slice coordinates.
+  void UpdateAnalyticIntersection(vtkMRMLMarkupsShapeNode * shapeNode,
+                                  const double * sliceOrigin, const double * sliceNormal);
+  // Sphere set : intersection circles, or outlines in Projection mode.
+  void AppendSphereSetCircles(vtkMRMLMarkupsShapeNode * shapeNode,
+                              const double * sliceOrigin, const double * sliceNormal,
+                              const double * sliceAxis1, const double * sliceAxis2,
+                              vtkPoints * points, vtkCellArray * lines);
+  void AppendSliceCircle(const double * centerWorld, const double * axis1World, const double * axis2World,
+                         double radiusWorld, vtkPoints * points, vtkCellArray * lines);
+  // Sides for a circle of this radius to look smooth at the current zoom factor.
+  int GetSliceCircleNumberOfSides(double radiusWorld);
+  // Circle points mapped to the slice, without closing point; returns the first point id.
+  vtkIdType InsertSliceCirclePoints(const double * centerWorld, const double * axis1World, const double * axis2World,
+                                    double radiusWorld, int numberOfSides, vtkPoints * points);
+  void AppendSliceSegment(const double * p1World, const double * p2World,
+                          vtkPoints * points, vtkCellArray * lines);
+  void AppendSliceMarker(const double * pointWorld, vtkPoints * points, vtkCellArray * lines);
 
   vtkSmartPointer<vtkGlyphSource2D> MiddlePointSource;
   vtkSmartPointer<vtkPolyDataMapper2D> MiddlePointDataMapper;
@@ -107,7 +139,12 @@ protected:
   vtkSmartPointer<vtkTransformPolyDataFilter> WorldToSliceTransformer;
   vtkSmartPointer<vtkSampleImplicitFunctionFilter> SliceDistance;
   vtkSmartPointer<vtkPlane> WorldPlane;
-  vtkSmartPointer<vtkCutter> WorldCutter;
+  vtkSmartPointer<vtkCutter> WorldCutter; // Tube
+  vtkSmartPointer<vtkPolyData> SliceIntersection; // Sphere, sphere set, Ring, Disk
+  vtkMTimeType SliceIntersectionShapeWorldVersion = 0;
+  vtkMTimeType SliceIntersectionTransformTime = 0;
+  double SliceIntersectionViewScaleFactor = 0.0;
+  int SliceIntersectionDrawMode = -1;
   vtkSmartPointer<vtkPolyDataMapper2D> WorldCutMapper;
   vtkSmartPointer<vtkActor2D> WorldCutActor;
   
@@ -115,19 +152,22 @@ protected:
   vtkSmartPointer<vtkPolyDataMapper2D> RadiusMapper;
   vtkSmartPointer<vtkActor2D> RadiusActor;
   
-  vtkSmartPointer<vtkDiskSource> DiskSource;
-  vtkSmartPointer<vtkDiskSource> RingSource;
-  vtkSmartPointer<vtkSphereSource> SphereSource;
-  
-  vtkSmartPointer<vtkParametricSpline> Spline;
-  vtkSmartPointer<vtkParametricFunctionSource> SplineFunctionSource;
-  vtkSmartPointer<vtkTubeFilter> Tube;
-  
+  // Input is the shape geometry owned by the markups node.
+  vtkSmartPointer<vtkTransform> ShapeWorldToSliceTransform;
   vtkSmartPointer<vtkTransformPolyDataFilter> ShapeWorldToSliceTransformer;
   vtkSmartPointer<vtkTransformPolyDataFilter> ShapeCutWorldToSliceTransformer;
+  vtkSmartPointer<vtkPolyData> SliceProjection; // Input of ShapeMapper
+  vtkMTimeType SliceProjectionShapeWorldVersion = 0;
+  double SliceProjectionOrientation[8] = { 0.0 }; // First two rows of ShapeWorldToSliceTransform
+  double SliceProjectionViewScaleFactor = 0.0;
   vtkSmartPointer<vtkPolyDataMapper2D> ShapeMapper;
   vtkSmartPointer<vtkActor2D> ShapeActor;
   vtkSmartPointer<vtkProperty2D> ShapeProperty;
+  // Bounding sphere of the shape in the view's spatial index, for event rejection.
+  void UpdateSpatialIndex(vtkMRMLMarkupsShapeNode * shapeNode, bool indexed);
+  vtkMRMLAbstractViewNode * SpatialIndexViewNode = nullptr;
+  // Shape resolution in this view, see vtkMRMLMarkupsShapeNode::GetViewResolution().
+  int ViewResolution = 0;
   
 private:
   vtkSlicerShapeRepresentation2D(const vtkSlicerShapeRepresentation2D&) = delete;
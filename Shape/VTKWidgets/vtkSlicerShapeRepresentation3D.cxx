@@ -20,16 +20,26 @@
 
 #include "vtkSlicerShapeRepresentation3D.h"
 
+#include "vtkMRMLMarkupsShapeDisplayNode.h"
 #include "vtkMRMLMarkupsShapeNode.h"
+#include "vtkShapeTimingCounters.h"
+#include "vtkSlicerShapeSpatialIndex.h"
 
 // VTK includes
 #include <vtkActor.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
 #include <vtkCutter.h>
+#include <vtkDoubleArray.h>
+#include <vtkGlyph3DMapper.h>
+#include <vtkOpenGLSphereMapper.h>
 #include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
-#include <vtkTupleInterpolator.h>
-#include <vtkPointData.h>
+#include <vtkRenderer.h>
 
 //------------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerShapeRepresentation3D);
@@ -37,13 +47,9 @@ vtkStandardNewMacro(vtkSlicerShapeRepresentation3D);
 //------------------------------------------------------------------------------
 vtkSlicerShapeRepresentation3D::vtkSlicerShapeRepresentation3D()
 {
-  this->DiskSource = vtkSmartPointer<vtkDiskSource>::New();
-  this->RingSource = vtkSmartPointer<vtkDiskSource>::New();
   this->RadiusSource = vtkSmartPointer<vtkLineSource>::New();
-  this->SphereSource = vtkSmartPointer<vtkSphereSource>::New();
   
   this->ShapeMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-  //this->ShapeMapper->SetInputConnection(this->DiskSource->GetOutputPort());
   this->ShapeMapper->SetScalarVisibility(true);
   this->ShapeProperty = vtkSmartPointer<vtkProperty>::New();
   this->ShapeProperty->DeepCopy(this->GetControlPointsPipeline(Selected)->Property);
@@ -51,6 +57,32 @@ vtkSlicerShapeRepresentation3D::vtkSlicerShapeRepresentation3D()
   this->ShapeActor->SetMapper(this->ShapeMapper);
   this->ShapeActor->SetProperty(this->ShapeProperty);
   
+  this->SphereSetGlyphSource = vtkSmartPointer<vtkSphereSource>::New();
+  this->SphereSetGlyphSource->SetRadius(1.0);
+  this->SphereSetMapper = vtkSmartPointer<vtkGlyph3DMapper>::New();
+  this->SphereSetMapper->SetSourceConnection(this->SphereSetGlyphSource->GetOutputPort());
+  this->SphereSetMapper->SetScaleArray("SphereRadius");
+  this->SphereSetMapper->SetScaleModeToScaleByMagnitude();
+  this->SphereSetMapper->SetScaleFactor(1.0);
+  this->SphereSetMapper->OrientOff();
+  this->SphereSetMapper->ScalarVisibilityOff();
+  
+  this->SphereImpostor = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> impostorCenter;
+  impostorCenter->InsertNextPoint(0.0, 0.0, 0.0);
+  vtkNew<vtkCellArray> impostorVertex;
+  impostorVertex->InsertNextCell(1);
+  impostorVertex->InsertCellPoint(0);
+  vtkNew<vtkDoubleArray> impostorRadius;
+  impostorRadius->SetName("SphereRadius");
+  impostorRadius->InsertNextValue(1.0);
+  this->SphereImpostor->SetPoints(impostorCenter);
+  this->SphereImpostor->SetVerts(impostorVertex);
+  this->SphereImpostor->GetPointData()->AddArray(impostorRadius);
+  this->SphereImpostorMapper = vtkSmartPointer<vtkOpenGLSphereMapper>::New();
+  this->SphereImpostorMapper->SetScaleArray("SphereRadius");
+  this->SphereImpostorMapper->ScalarVisibilityOff();
+  
   this->MiddlePointSource = vtkSmartPointer<vtkSphereSource>::New();
   this->MiddlePointMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
   this->MiddlePointMapper->SetInputConnection(this->MiddlePointSource->GetOutputPort());
@@ -65,21 +97,31 @@ vtkSlicerShapeRepresentation3D::vtkSlicerShapeRepresentation3D()
   this->RadiusActor->SetMapper(this->RadiusMapper);
   this->RadiusActor->SetProperty(this->GetControlPointsPipeline(Unselected)->Property);
   
-  this->Spline = vtkSmartPointer<vtkParametricSpline>::New();
-  vtkNew<vtkPoints> points;
-  const double point[3] = { 0.0 };
-  points->InsertNextPoint(point);
-  this->Spline->SetPoints(points);
-  this->SplineFunctionSource = vtkSmartPointer<vtkParametricFunctionSource>::New();
-  this->SplineFunctionSource->SetParametricFunction(this->Spline);
-  this->Tube = vtkSmartPointer<vtkTubeFilter>::New();
-  this->Tube->SetNumberOfSides(20);
-  this->Tube->SetVaryRadiusToVaryRadiusByAbsoluteScalar();
-  this->Tube->SetInputConnection(this->SplineFunctionSource->GetOutputPort());
+  this->CameraModifiedCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->CameraModifiedCallback->SetClientData( reinterpret_cast<void *>(this) );
+  this->CameraModifiedCallback->SetCallback( vtkSlicerShapeRepresentation3D::OnCameraModified );
+}
+
+//------------------------------------------------------------------------------
+vtkSlicerShapeRepresentation3D::~vtkSlicerShapeRepresentation3D()
+{
+  if (this->ObservedCamera)
+  {
+    this->ObservedCamera->RemoveObserver(this->CameraModifiedCallback);
+  }
+  vtkSlicerShapeSpatialIndex::RemoveViewShape(this->SpatialIndexViewNode, this);
 }
 
 //------------------------------------------------------------------------------
-vtkSlicerShapeRepresentation3D::~vtkSlicerShapeRepresentation3D() = default;
+void vtkSlicerShapeRepresentation3D::UpdateSpatialIndex(vtkMRMLMarkupsShapeNode * shapeNode, bool indexed)
+{
+  if (this->SpatialIndexViewNode != this->GetViewNode())
+  {
+    vtkSlicerShapeSpatialIndex::RemoveViewShape(this->SpatialIndexViewNode, this);
+    this->SpatialIndexViewNode = this->GetViewNode();
+  }
+  vtkSlicerShapeSpatialIndex::UpdateViewShape(this->SpatialIndexViewNode, this, shapeNode, indexed);
+}
 
 //------------------------------------------------------------------------------
 void vtkSlicerShapeRepresentation3D::PrintSelf(ostream& os, vtkIndent indent)
@@ -124,6 +166,86 @@ int vtkSlicerShapeRepresentation3D::RenderOverlay(vtkViewport* viewport)
   return count;
 }
 
+//------------------------------------------------------------------------------
+bool vtkSlicerShapeRepresentation3D::GetSphereImpostors(vtkMRMLMarkupsShapeNode * shapeNode)
+{
+  vtkMRMLMarkupsShapeDisplayNode * displayNode = vtkMRMLMarkupsShapeDisplayNode::SafeDownCast(this->MarkupsDisplayNode);
+  return displayNode && displayNode->GetSphereImpostors()
+         && shapeNode->GetShapeName() == vtkMRMLMarkupsShapeNode::Sphere;
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation3D::UpdateViewResolution(vtkMRMLMarkupsShapeNode * shapeNode)
+{
+  this->ViewResolution = shapeNode->GetViewResolution(this->ViewScaleFactorMmPerPixel);
+  if (this->GetSphereImpostors(shapeNode))
+  {
+    // No mesh : a sphere set's geometry only has the centers, a single sphere is set here.
+    if (shapeNode->GetSphereSet())
+    {
+      shapeNode->UpdateShapeWorld(this->ViewResolution);
+      this->SphereImpostorMapper->SetInputConnection(shapeNode->GetShapeWorldConnection(this->ViewResolution));
+    }
+    else
+    {
+      this->SphereImpostorMapper->SetInputData(this->SphereImpostor);
+    }
+    this->ShapeActor->SetMapper(this->SphereImpostorMapper);
+    return;
+  }
+  shapeNode->UpdateShapeWorld(this->ViewResolution);
+  if (shapeNode->GetShapeName() == vtkMRMLMarkupsShapeNode::Sphere && shapeNode->GetSphereSet())
+  {
+    // The resolution applies to the glyph, the node's geometry only has the centers.
+    this->SphereSetGlyphSource->SetThetaResolution(this->ViewResolution);
+    this->SphereSetGlyphSource->SetPhiResolution(this->ViewResolution);
+    this->SphereSetMapper->SetInputConnection(shapeNode->GetShapeWorldConnection(this->ViewResolution));
+    this->ShapeActor->SetMapper(this->SphereSetMapper);
+    return;
+  }
+  this->ShapeMapper->SetInputConnection(shapeNode->GetShapeWorldConnection(this->ViewResolution));
+  this->ShapeActor->SetMapper(this->ShapeMapper);
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation3D::UpdateCameraObserver()
+{
+  vtkCamera * camera = this->Renderer ? this->Renderer->GetActiveCamera() : nullptr;
+  if (camera == this->ObservedCamera)
+  {
+    return;
+  }
+  if (this->ObservedCamera)
+  {
+    this->ObservedCamera->RemoveObserver(this->CameraModifiedCallback);
+  }
+  this->ObservedCamera = camera;
+  if (camera)
+  {
+    camera->AddObserver(vtkCommand::ModifiedEvent, this->CameraModifiedCallback);
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkSlicerShapeRepresentation3D::OnCameraModified(vtkObject * caller, unsigned long event,
+                                                      void * clientData, void * callData)
+{
+  vtkSlicerShapeRepresentation3D * self = reinterpret_cast<vtkSlicerShapeRepresentation3D*>(clientData);
+  vtkMRMLMarkupsShapeNode * shapeNode = self ? vtkMRMLMarkupsShapeNode::SafeDownCast(self->GetMarkupsNode()) : nullptr;
+  if (!shapeNode || shapeNode->GetResolutionMode() != vtkMRMLMarkupsShapeNode::AutomaticResolution)
+  {
+    return;
+  }
+  self->UpdateViewScaleFactor();
+  // Levels are few : most camera changes keep the current geometry.
+  if (shapeNode->GetViewResolution(self->ViewScaleFactorMmPerPixel) == self->ViewResolution)
+  {
+    return;
+  }
+  self->UpdateViewResolution(shapeNode);
+  self->NeedToRenderOn();
+}
+
 //------------------------------------------------------------------------------
 int vtkSlicerShapeRepresentation3D::RenderOpaqueGeometry(vtkViewport* viewport)
 {
@@ -208,13 +330,31 @@ void vtkSlicerShapeRepresentation3D::UpdateFromMRML(vtkMRMLNode* caller,
     vtkMRMLMarkupsShapeNode::SafeDownCast(this->GetMarkupsNode());
   if (!shapeNode)
   {
+    this->UpdateSpatialIndex(shapeNode, false);
     return;
   }
   
+  vtkShapeTimingCounters::ScopedTimer timer("UpdateFromMRML3D", shapeNode->GetShapeName());
+  this->UpdateSpatialIndex(shapeNode, true);
+  this->UpdateCameraObserver();
+  if (shapeNode->GetResolutionMode() == vtkMRMLMarkupsShapeNode::AutomaticResolution)
+  {
+    this->UpdateViewScaleFactor();
+  }
+  // Generated once by the node for all views at the same resolution.
+  this->UpdateViewResolution(shapeNode);
+  
   switch (shapeNode->GetShapeName())
   {
     case vtkMRMLMarkupsShapeNode::Sphere :
-      this->UpdateSphereFromMRML(caller, event, callData);
+      if (shapeNode->GetSphereSet())
+      {
+        this->UpdateSphereSetFromMRML(caller, event, callData);
+      }
+      else
+      {
+        this->UpdateSphereFromMRML(caller, event, callData);
+      }
       break;
     case vtkMRMLMarkupsShapeNode::Ring :
       this->UpdateRingFromMRML(caller, event, callData);
@@ -265,8 +405,6 @@ void vtkSlicerShapeRepresentation3D::UpdateDiskFromMRML(vtkMRMLNode* caller,
 {
   vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->GetMarkupsNode());
   
-  this->ShapeActor->SetVisibility(shapeNode->GetNumberOfDefinedControlPoints(true) == 3);
-  this->TextActor->SetVisibility(shapeNode->GetNumberOfDefinedControlPoints(true) == 3);
   this->RadiusActor->SetVisibility(false);
   this->MiddlePointActor->SetVisibility(false);
   
@@ -276,50 +414,15 @@ void vtkSlicerShapeRepresentation3D::UpdateDiskFromMRML(vtkMRMLNode* caller,
   if (!shapeNode->DescribeDiskPointSpacing(closestPoint, farthestPoint, innerRadius, outerRadius))
   {
     vtkDebugMacro("Point proximity description failure.");
-    return;
-  }
-  this->ShapeMapper->SetInputConnection(this->DiskSource->GetOutputPort());
-  
-  if (shapeNode->GetNumberOfDefinedControlPoints(true) == 3)
-  {
-    double p1[3] = { 0.0 }; // center
-    double p2[3] = { 0.0 };
-    double p3[3] = { 0.0 };
-    shapeNode->GetNthControlPointPositionWorld(0, p1);
-    shapeNode->GetNthControlPointPositionWorld(1, p2);
-    shapeNode->GetNthControlPointPositionWorld(2, p3);
-    
-    // Relative to center
-    double rp2[3] = { p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2] };
-    double rp3[3] = { p3[0] - p1[0], p3[1] - p1[1], p3[2] - p1[2] };
-    
-    double normal[3] = { 0.0 };
-    vtkMath::Cross(rp2, rp3, normal);
-    if (normal[0] == 0.0 && normal[1] == 0.0 && normal[2] == 0.0)
-    {
-      vtkDebugMacro("Got zero normal.");
-      return;
-    }
-    
-    this->DiskSource->SetCenter(p1);
-    this->DiskSource->SetNormal(normal);
-    this->DiskSource->SetOuterRadius(innerRadius);
-    this->DiskSource->SetInnerRadius(outerRadius);
-  }
-  else
-  {
     this->ShapeActor->SetVisibility(false);
     this->TextActor->SetVisibility(false);
+    return;
   }
   
-  this->DiskSource->SetCircumferentialResolution((int) shapeNode->GetResolution());
-  this->DiskSource->Update();
-  
   this->ShapeActor->SetVisibility(this->GetAllControlPointsVisible() && shapeNode->GetNumberOfDefinedControlPoints(true) == 3);
   this->TextActor->SetVisibility(this->GetAllControlPointsVisible() && shapeNode->GetNumberOfDefinedControlPoints(true) == 3);
   
   int controlPointType = this->GetAllControlPointsSelected() ? Selected : Unselected;
-  this->ShapeActor->SetProperty(this->GetControlPointsPipeline(controlPointType)->Property);
   this->TextActor->SetTextProperty(this->GetControlPointsPipeline(controlPointType)->TextProperty);
   
   double opacity = this->MarkupsDisplayNode->GetOpacity();
@@ -331,18 +434,11 @@ void vtkSlicerShapeRepresentation3D::UpdateDiskFromMRML(vtkMRMLNode* caller,
   this->TextActorPositionWorld[0] = farthestPoint[0];
   this->TextActorPositionWorld[1] = farthestPoint[1];
   this->TextActorPositionWorld[2] = farthestPoint[2];
-  
-  shapeNode->SetShapeWorld(this->DiskSource->GetOutput());
 }
 
 //---------------------------- Ring ------------------------------------------
 void vtkSlicerShapeRepresentation3D::UpdateRingFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData)
 {
-  if (!this->DoUpdateFromMRML)
-  {
-    return;
-  }
-  
   vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->GetMarkupsNode());
   
   bool visibility = shapeNode->GetNumberOfDefinedControlPoints(true) == 3;
@@ -364,55 +460,20 @@ void vtkSlicerShapeRepresentation3D::UpdateRingFromMRML(vtkMRMLNode* caller, uns
   
   this->MiddlePointSource->SetCenter(center);
   this->MiddlePointSource->SetRadius(this->ControlPointSize);
-  this->ShapeMapper->SetInputConnection(this->RingSource->GetOutputPort());
-  
-  double lineLength = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
-  double normal[3] = { 0.0 };
   
   // Centered mode : p1 is center, line length is radius.
   if (shapeNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
   {
-    // Relative to p1 (center)
-    double rp2[3] = { p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2] };
-    double rp3[3] = { p3[0] - p1[0], p3[1] - p1[1], p3[2] - p1[2] };
-    
-    vtkMath::Cross(rp2, rp3, normal);
-    if (normal[0] == 0.0 && normal[1] == 0.0 && normal[2] == 0.0)
-    {
-      vtkDebugMacro("Got zero normal.");
-      return;
-    }
-    this->RingSource->SetCenter(p1);
-    this->RingSource->SetNormal(normal);
-    this->RingSource->SetOuterRadius(lineLength);
-    this->RingSource->SetInnerRadius(lineLength - this->ViewScaleFactorMmPerPixel);
     this->RadiusSource->SetPoint1(p1);
-    
     this->MiddlePointActor->SetVisibility(false);
   }
-  // Circumferentiale mode : center is half way between p1 and p2, radius is half of line length.
+  // Circumferential mode : center is half way between p1 and p2, radius is half of line length.
   else
   {
-    double radius = lineLength / 2.0;
-    
-    // relative to center
-    double rp2[3] = { p2[0] - center[0], p2[1] - center[1], p2[2] - center[2] };
-    double rp3[3] = { p3[0] - center[0], p3[1] - center[1], p3[2] - center[2] };
-    
-    vtkMath::Cross(rp2, rp3, normal);
-    this->RingSource->SetCenter(center);
-    this->RingSource->SetNormal(normal);
-    this->RingSource->SetOuterRadius(radius);
-    this->RingSource->SetInnerRadius(radius - this->ViewScaleFactorMmPerPixel);
     this->RadiusSource->SetPoint1(center);
-    
     this->MiddlePointActor->SetVisibility(true);
   }
   
-  this->RingSource->SetCircumferentialResolution((int) shapeNode->GetResolution());
-  this->RingSource->Update();
-  shapeNode->SetShapeWorld(this->RingSource->GetOutput());
-  
   this->RadiusSource->SetPoint2(p2);
   this->RadiusSource->Update();
   
@@ -427,22 +488,7 @@ void vtkSlicerShapeRepresentation3D::UpdateRingFromMRML(vtkMRMLNode* caller, uns
   // Text is badly colored
   this->TextActor->SetTextProperty(this->GetControlPointsPipeline(controlPointType)->TextProperty);
   
-  // Stick p3 on ring.
-  this->DoUpdateFromMRML = false;
-  vtkIdType closestIdOnRing = this->RingSource->GetOutput()->FindPoint(p3);
-  if (closestIdOnRing >= 0)
-  {
-    double * closestPointOnRing = this->RingSource->GetOutput()->GetPoint(closestIdOnRing);
-    if (p3[0] != closestPointOnRing[0] || p3[1] != closestPointOnRing[1] || p3[2] != closestPointOnRing[2])
-    {
-      if (shapeNode->GetNumberOfDefinedControlPoints() == 3)
-      {
-        shapeNode->SetNthControlPointPositionWorld(2, closestPointOnRing);
-      }
-    }
-  }
-  this->DoUpdateFromMRML = true;
-  
+  // p3 is kept on the ring by the node.
   this->TextActorPositionWorld[0] = p3[0];
   this->TextActorPositionWorld[1] = p3[1];
   this->TextActorPositionWorld[2] = p3[2];
@@ -462,41 +508,40 @@ void vtkSlicerShapeRepresentation3D::UpdateSphereFromMRML(vtkMRMLNode* caller, u
   center[1] = (p1[1] + p2[1]) / 2.0;
   center[2] = (p1[2] + p2[2]) / 2.0;
   
-  this->ShapeMapper->SetInputConnection(this->SphereSource->GetOutputPort());
-  double lineLength = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
-  
   // Centered mode : p1 is center, line length is radius.
   if (shapeNode->GetRadiusMode() == vtkMRMLMarkupsShapeNode::Centered)
   {
-    this->SphereSource->SetCenter(p1);
-    this->SphereSource->SetRadius(lineLength);
     this->RadiusSource->SetPoint1(p1);
     this->MiddlePointActor->SetVisibility(false);
   }
   // Circumferential mode : center is half way between p1 and p2, radius is half of line length.
   else
   {
-    double radius = lineLength / 2.0;
-    
-    this->SphereSource->SetCenter(center);
-    this->SphereSource->SetRadius(radius);
     this->RadiusSource->SetPoint1(center);
     this->MiddlePointActor->SetVisibility(true);
   }
-  this->SphereSource->SetPhiResolution(shapeNode->GetResolution());
-  this->SphereSource->SetThetaResolution(shapeNode->GetResolution());
-  this->SphereSource->Update();
-  shapeNode->SetShapeWorld(this->SphereSource->GetOutput());
   
   this->RadiusSource->SetPoint2(p2);
   this->RadiusSource->Update();
   
+  double impostorCenter[3] = { 0.0 };
+  double impostorNormal[3] = { 0.0 }; // Unused here
+  double impostorRadius = 0.0, innerRadius = 0.0;
+  if (this->GetSphereImpostors(shapeNode)
+    && shapeNode->DescribeShapeWorld(impostorCenter, impostorNormal, impostorRadius, innerRadius))
+  {
+    this->SphereImpostor->GetPoints()->SetPoint(0, impostorCenter);
+    this->SphereImpostor->GetPoints()->Modified();
+    vtkDoubleArray::SafeDownCast(this->SphereImpostor->GetPointData()->GetArray("SphereRadius"))->SetValue(0, impostorRadius);
+    this->SphereImpostor->GetPointData()->GetArray("SphereRadius")->Modified();
+    this->SphereImpostor->Modified();
+  }
+  
   this->ShapeActor->SetVisibility(this->GetAllControlPointsVisible() && shapeNode->GetNumberOfDefinedControlPoints(true) == 2);
   this->RadiusActor->SetVisibility(this->GetAllControlPointsVisible() && shapeNode->GetNumberOfDefinedControlPoints(true) == 2);
   this->TextActor->SetVisibility(this->GetAllControlPointsVisible() && shapeNode->GetNumberOfDefinedControlPoints(true) == 2);
   
   int controlPointType = this->GetAllControlPointsSelected() ? Selected : Unselected;
-  this->ShapeActor->SetProperty(this->GetControlPointsPipeline(controlPointType)->Property);
   this->RadiusActor->SetProperty(this->GetControlPointsPipeline(controlPointType)->Property);
   this->TextActor->SetTextProperty(this->GetControlPointsPipeline(controlPointType)->TextProperty);
   
@@ -511,12 +556,42 @@ void vtkSlicerShapeRepresentation3D::UpdateSphereFromMRML(vtkMRMLNode* caller, u
   this->TextActorPositionWorld[2] = p2[2];
 }
 
-//---------------------------- Sphere ------------------------------------------
-void vtkSlicerShapeRepresentation3D::UpdateTubeFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData)
+//---------------------------- Sphere set ------------------------------------
+void vtkSlicerShapeRepresentation3D::UpdateSphereSetFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData)
 {
-  this->Superclass::UpdateFromMRML(caller, event, callData);
-  this->NeedToRenderOn();
+  vtkMRMLMarkupsShapeNode * shapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(this->GetMarkupsNode());
+  
+  // Per sphere radius lines and middle points would defeat a single glyph mapper.
+  this->RadiusActor->SetVisibility(false);
+  this->MiddlePointActor->SetVisibility(false);
+  
+  const bool visibility = this->GetAllControlPointsVisible() && shapeNode->GetNumberOfSpheres() > 0;
+  this->ShapeActor->SetVisibility(visibility);
+  this->TextActor->SetVisibility(visibility);
+  if (!visibility)
+  {
+    return;
+  }
+  
+  int controlPointType = this->GetAllControlPointsSelected() ? Selected : Unselected;
+  this->TextActor->SetTextProperty(this->GetControlPointsPipeline(controlPointType)->TextProperty);
+  
+  double opacity = this->MarkupsDisplayNode->GetOpacity();
+  double fillOpacity = opacity * this->MarkupsDisplayNode->GetFillOpacity();
+  this->ShapeProperty->DeepCopy(this->GetControlPointsPipeline(controlPointType)->Property);
+  this->ShapeProperty->SetOpacity(fillOpacity);
+  this->ShapeActor->SetProperty(this->ShapeProperty);
   
+  double p1[3] = { 0.0 };
+  shapeNode->GetNthControlPointPositionWorld(0, p1);
+  this->TextActorPositionWorld[0] = p1[0];
+  this->TextActorPositionWorld[1] = p1[1];
+  this->TextActorPositionWorld[2] = p1[2];
+}
+
+//---------------------------- Tube ------------------------------------------
+void vtkSlicerShapeRepresentation3D::UpdateTubeFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData)
+{
   this->MiddlePointActor->SetVisibility(false);
   this->RadiusActor->SetVisibility(false);
   
@@ -529,66 +604,9 @@ void vtkSlicerShapeRepresentation3D::UpdateTubeFromMRML(vtkMRMLNode* caller, uns
     return;
   }
   
-  this->TextActor->SetVisibility(true);
-  this->ShapeMapper->SetInputConnection(this->Tube->GetOutputPort());
-  
-  vtkNew<vtkPoints> splinePoints;
-  vtkNew<vtkTupleInterpolator> interpolatedRadius;
-  interpolatedRadius->SetInterpolationTypeToLinear();
-  interpolatedRadius->SetNumberOfComponents(1);
-  int interpolatorIndex = 0;
-  for (int i = 0; i < shapeNode->GetNumberOfControlPoints(); i = i + 2)
-  {
-    double middlePoint[3] = { 0.0 };
-    double p1[3] = { 0.0 };
-    double p2[3] = { 0.0 };
-    shapeNode->GetNthControlPointPositionWorld(i, p1);
-    shapeNode->GetNthControlPointPositionWorld(i + 1, p2);
-    middlePoint[0] = (p1[0] + p2[0]) / 2.0;
-    middlePoint[1] = (p1[1] + p2[1]) / 2.0;
-    middlePoint[2] = (p1[2] + p2[2]) / 2.0;
-    splinePoints->InsertNextPoint(middlePoint);
-    
-    double radius = std::sqrt(vtkMath::Distance2BetweenPoints(p1, p2)) / 2.0;
-    interpolatedRadius->AddTuple(interpolatorIndex, &radius);
-    //interpolatedRadius->AddTuple(i + 1, &radius);
-    interpolatorIndex++;
-  }
-  int numberOfPoints = splinePoints->GetNumberOfPoints();
-  
-  this->Spline->SetPoints(splinePoints);
-  this->SplineFunctionSource->SetUResolution(100 * numberOfPoints);
-  this->SplineFunctionSource->SetVResolution(100 * numberOfPoints);
-  this->SplineFunctionSource->SetWResolution(100 * numberOfPoints);
-  this->SplineFunctionSource->Update();
-  vtkPolyData * splinePolyData = this->SplineFunctionSource->GetOutput();
-  numberOfPoints = splinePolyData->GetNumberOfPoints();
-  
-  // https://kitware.github.io/vtk-examples/site/Cxx/VisualizationAlgorithms/TubesFromSplines/
-  vtkSmartPointer<vtkDoubleArray> tubeRadius = vtkSmartPointer<vtkDoubleArray>::New();
-  tubeRadius->SetNumberOfTuples(numberOfPoints);
-  tubeRadius->SetName("TubeRadius");
-  double tMin = interpolatedRadius->GetMinimumT();
-  double tMax = interpolatedRadius->GetMaximumT();
-  double r;
-  for (unsigned int i = 0; i < numberOfPoints; ++i)
-  {
-    double t = (tMax - tMin) / (numberOfPoints - 1) * i + tMin;
-    interpolatedRadius->InterpolateTuple(t, &r);
-    tubeRadius->SetTuple1(i, r);
-  }
-  
-  splinePolyData->GetPointData()->AddArray(tubeRadius);
-  splinePolyData->GetPointData()->SetActiveScalars("TubeRadius");
-  
-  this->Tube->SetNumberOfSides(shapeNode->GetResolution());
-  this->Tube->Update();
   this->ShapeActor->SetVisibility(true);
-  shapeNode->SetShapeWorld(Tube->GetOutput());
   
-  // Doesn't work (color).
   int controlPointType = this->GetAllControlPointsSelected() ? Selected : Unselected;
-  this->ShapeActor->SetProperty(this->GetControlPointsPipeline(controlPointType)->Property);
   this->TextActor->SetTextProperty(this->GetControlPointsPipeline(controlPointType)->TextProperty);
   
   double opacity = this->MarkupsDisplayNode->GetOpacity();
@@ -28,15 +28,16 @@
 
 // VTK includes
 #include <vtkWeakPointer.h>
-#include <vtkDiskSource.h>
 #include <vtkLineSource.h>
 #include <vtkSphereSource.h>
-#include <vtkTubeFilter.h>
-#include <vtkParametricSpline.h>
-#include <vtkParametricFunctionSource.h>
 
 //------------------------------------------------------------------------------
+class vtkCallbackCommand;
+class vtkCamera;
 class vtkCutter;
+class vtkGlyph3DMapper;
+class vtkOpenGLSphereMapper;
+class vtkMRMLMarkupsShapeNode;
 class vtkPlane;
 
 /**
@@ -79,33 +80,44 @@ protected:
 
   void BuildMiddlePoint();
   
-  vtkSmartPointer<vtkDiskSource> DiskSource;
-  vtkSmartPointer<vtkDiskSource> RingSource;
-  vtkSmartPointer<vtkSphereSource> SphereSource;
-  
   vtkSmartPointer<vtkLineSource> RadiusSource;
   vtkSmartPointer<vtkPolyDataMapper> RadiusMapper;
   vtkSmartPointer<vtkActor> RadiusActor;
   
-  vtkSmartPointer<vtkParametricSpline> Spline;
-  vtkSmartPointer<vtkParametricFunctionSource> SplineFunctionSource;
-  vtkSmartPointer<vtkTubeFilter> Tube;
-  
+  // Input is the shape geometry owned by the markups node.
   vtkSmartPointer<vtkPolyDataMapper> ShapeMapper;
   vtkSmartPointer<vtkActor> ShapeActor;
   vtkSmartPointer<vtkProperty> ShapeProperty;
+  // Bounding sphere of the shape in the view's spatial index, for event rejection.
+  void UpdateSpatialIndex(vtkMRMLMarkupsShapeNode * shapeNode, bool indexed);
+  vtkMRMLAbstractViewNode * SpatialIndexViewNode = nullptr;
+  // Shape resolution in this view, see vtkMRMLMarkupsShapeNode::GetViewResolution().
+  int ViewResolution = 0;
+  // Sphere set : one sphere glyph scaled at each center of the node's geometry.
+  vtkSmartPointer<vtkSphereSource> SphereSetGlyphSource;
+  vtkSmartPointer<vtkGlyph3DMapper> SphereSetMapper;
+  // Sphere impostors : one point per sphere, scaled by SphereRadius.
+  vtkSmartPointer<vtkPolyData> SphereImpostor; // Single sphere
+  vtkSmartPointer<vtkOpenGLSphereMapper> SphereImpostorMapper;
+  bool GetSphereImpostors(vtkMRMLMarkupsShapeNode * shapeNode);
+  // Connect to the node's geometry at the resolution suited to this view.
+  void UpdateViewResolution(vtkMRMLMarkupsShapeNode * shapeNode);
+  // AutomaticResolution : zooming does not update the representation from MRML,
+  // the resolution follows the camera instead, outside of rendering.
+  void UpdateCameraObserver();
+  static void OnCameraModified(vtkObject * caller, unsigned long event, void * clientData, void * callData);
+  vtkSmartPointer<vtkCallbackCommand> CameraModifiedCallback;
+  vtkWeakPointer<vtkCamera> ObservedCamera;
   
   void UpdateDiskFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData=nullptr);
   void UpdateRingFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData=nullptr);
   void UpdateSphereFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData=nullptr);
+  void UpdateSphereSetFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData=nullptr);
   void UpdateTubeFromMRML(vtkMRMLNode* caller, unsigned long event, void* callData=nullptr);
 
 private:
   vtkSlicerShapeRepresentation3D(const vtkSlicerShapeRepresentation3D&) = delete;
   void operator=(const vtkSlicerShapeRepresentation3D&) = delete;
-  
-  // Ring : p3 is moved during UpdateFromMRML, block recursion.
-  bool DoUpdateFromMRML = true;
 };
 
 #endif // __vtkslicerShape_LOWERrepresentation3d_h_
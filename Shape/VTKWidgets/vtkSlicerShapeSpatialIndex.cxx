@@ -0,0 +1,473 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#include "vtkSlicerShapeSpatialIndex.h"
+
+#include "vtkMRMLMarkupsShapeNode.h"
+
+// MRML includes
+#include <vtkMRMLAbstractViewNode.h>
+#include <vtkMRMLInteractionEventData.h>
+#include <vtkMRMLSliceNode.h>
+
+// VTK includes
+#include <vtkCamera.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+
+namespace
+{
+std::map<vtkMRMLAbstractViewNode*, vtkSmartPointer<vtkSlicerShapeSpatialIndex>>& GetViewIndices()
+{
+  static std::map<vtkMRMLAbstractViewNode*, vtkSmartPointer<vtkSlicerShapeSpatialIndex>> viewIndices;
+  return viewIndices;
+}
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerShapeSpatialIndex);
+
+//----------------------------------------------------------------------------
+vtkSlicerShapeSpatialIndex::vtkSlicerShapeSpatialIndex() = default;
+
+//----------------------------------------------------------------------------
+vtkSlicerShapeSpatialIndex::~vtkSlicerShapeSpatialIndex() = default;
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfShapes: " << this->Shapes.size() << std::endl;
+  os << indent << "TolerancePixels: " << this->TolerancePixels << std::endl;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerShapeSpatialIndex * vtkSlicerShapeSpatialIndex::GetViewIndex(vtkMRMLAbstractViewNode * viewNode)
+{
+  if (!viewNode)
+  {
+    return nullptr;
+  }
+  vtkSmartPointer<vtkSlicerShapeSpatialIndex>& viewIndex = GetViewIndices()[viewNode];
+  // Also if a deleted view node had the same address.
+  if (!viewIndex || viewIndex->ViewNode != viewNode)
+  {
+    viewIndex = vtkSmartPointer<vtkSlicerShapeSpatialIndex>::New();
+    viewIndex->ViewNode = viewNode;
+  }
+  return viewIndex;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerShapeSpatialIndex * vtkSlicerShapeSpatialIndex::FindViewIndex(vtkMRMLAbstractViewNode * viewNode)
+{
+  auto found = GetViewIndices().find(viewNode);
+  if (found == GetViewIndices().end() || found->second->ViewNode != viewNode)
+  {
+    return nullptr;
+  }
+  return found->second;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::UpdateViewShape(vtkMRMLAbstractViewNode * viewNode, vtkObject * representation,
+                                                 vtkMRMLMarkupsShapeNode * shapeNode, bool indexed)
+{
+  double center[3] = { 0.0 };
+  double radius = 0.0;
+  if (!viewNode || !shapeNode || !indexed || !shapeNode->GetShapeWorldBoundingSphere(center, radius))
+  {
+    RemoveViewShape(viewNode, representation);
+    return;
+  }
+  GetViewIndex(viewNode)->SetShape(representation, center, radius);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::RemoveViewShape(vtkMRMLAbstractViewNode * viewNode, vtkObject * representation)
+{
+  auto found = GetViewIndices().find(viewNode);
+  if (found != GetViewIndices().end() && found->second->RemoveShape(representation))
+  {
+    // Last shape of the view.
+    GetViewIndices().erase(found);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerShapeSpatialIndex::IsViewShapeNearEvent(vtkMRMLAbstractViewNode * viewNode, vtkObject * representation,
+                                                      vtkMRMLInteractionEventData * eventData, vtkRenderer * renderer)
+{
+  vtkSlicerShapeSpatialIndex * viewIndex = FindViewIndex(viewNode);
+  return !viewIndex || viewIndex->IsShapeNearEvent(representation, eventData, renderer);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::SetShape(vtkObject * representation, const double * center, double radius)
+{
+  auto found = this->ShapeIndices.find(representation);
+  if (found == this->ShapeIndices.end())
+  {
+    Shape shape;
+    shape.Representation = representation;
+    this->ShapeIndices[representation] = (int) this->Shapes.size();
+    this->Shapes.push_back(shape);
+    this->TreeOutdated = true;
+    found = this->ShapeIndices.find(representation);
+  }
+  double * sphere = this->Shapes[found->second].Sphere;
+  if (sphere[0] == center[0] && sphere[1] == center[1] && sphere[2] == center[2]
+    && sphere[3] == radius && !this->TreeOutdated)
+  {
+    return;
+  }
+  sphere[0] = center[0];
+  sphere[1] = center[1];
+  sphere[2] = center[2];
+  sphere[3] = radius;
+  this->TreeMoved = true;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerShapeSpatialIndex::RemoveShape(vtkObject * representation)
+{
+  auto found = this->ShapeIndices.find(representation);
+  if (found == this->ShapeIndices.end())
+  {
+    return this->Shapes.empty();
+  }
+  const int index = found->second;
+  this->ShapeIndices.erase(found);
+  if (index != (int) this->Shapes.size() - 1)
+  {
+    this->Shapes[index] = this->Shapes.back();
+    this->ShapeIndices[this->Shapes[index].Representation] = index;
+  }
+  this->Shapes.pop_back();
+  this->Candidates.erase(representation);
+  this->TreeOutdated = true;
+  this->Modified();
+  return this->Shapes.empty();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerShapeSpatialIndex::GetNumberOfShapes()
+{
+  return (int) this->Shapes.size();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerShapeSpatialIndex::IsShapeNearEvent(vtkObject * representation,
+                                                  vtkMRMLInteractionEventData * eventData,
+                                                  vtkRenderer * renderer)
+{
+  if (!eventData || !renderer || !renderer->GetActiveCamera()
+    || this->ShapeIndices.find(representation) == this->ShapeIndices.end())
+  {
+    return true;
+  }
+  int displayPosition[2] = { 0 };
+  eventData->GetDisplayPosition(displayPosition);
+  double worldPosition[3] = { 0.0 };
+  eventData->GetWorldPosition(worldPosition);
+  const double position[5] = { (double) displayPosition[0], (double) displayPosition[1],
+                               worldPosition[0], worldPosition[1], worldPosition[2] };
+  const vtkMTimeType cameraTime = renderer->GetActiveCamera()->GetMTime();
+  // Same event for all widgets of the view.
+  if (this->CandidatesEventData != eventData || !std::equal(position, position + 5, this->CandidatesPosition)
+    || this->CandidatesCameraTime != cameraTime || this->CandidatesIndexTime != this->GetMTime())
+  {
+    this->FindCandidates(eventData, renderer);
+    this->CandidatesEventData = eventData;
+    std::copy(position, position + 5, this->CandidatesPosition);
+    this->CandidatesCameraTime = cameraTime;
+    this->CandidatesIndexTime = this->GetMTime();
+  }
+  return this->Candidates.find(representation) != this->Candidates.end();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::FindCandidates(vtkMRMLInteractionEventData * eventData,
+                                                vtkRenderer * renderer)
+{
+  this->Candidates.clear();
+  if (this->TreeOutdated)
+  {
+    this->Build();
+  }
+  else if (this->TreeMoved)
+  {
+    this->Refit();
+  }
+  if (this->Tree.empty())
+  {
+    return;
+  }
+  
+  // Distance test of a sphere to the event position.
+  std::function<bool(const double *)> isNear;
+  vtkMRMLSliceNode * sliceNode = vtkMRMLSliceNode::SafeDownCast(this->ViewNode);
+  double origin[3] = { 0.0 };
+  double direction[3] = { 0.0 };
+  double tolerance = 0.0;
+  bool parallel = false;
+  double parallelMmPerPixel = 0.0;
+  double perspectiveMmPerPixel = 0.0;
+  if (sliceNode)
+  {
+    // What is drawn of a shape is in the slice plane, within its radius of the projected center.
+    if (!eventData->IsWorldPositionValid())
+    {
+      for (const Shape& shape : this->Shapes)
+      {
+        this->Candidates.insert(shape.Representation);
+      }
+      return;
+    }
+    eventData->GetWorldPosition(origin);
+    vtkMatrix4x4 * sliceToRAS = sliceNode->GetSliceToRAS();
+    vtkMatrix4x4 * xyToRAS = sliceNode->GetXYToRAS();
+    double mmPerPixel[3] = { 0.0 };
+    for (int i = 0; i < 3; i++)
+    {
+      direction[i] = sliceToRAS->GetElement(i, 2);
+      mmPerPixel[i] = xyToRAS->GetElement(i, 0);
+    }
+    vtkMath::Normalize(direction);
+    tolerance = this->TolerancePixels * vtkMath::Norm(mmPerPixel);
+    isNear = [&](const double * sphere)
+    {
+      double relative[3] = { sphere[0] - origin[0], sphere[1] - origin[1], sphere[2] - origin[2] };
+      const double height = vtkMath::Dot(relative, direction);
+      for (int i = 0; i < 3; i++)
+      {
+        relative[i] -= height * direction[i];
+      }
+      const double distance = sphere[3] + tolerance;
+      return vtkMath::Dot(relative, relative) <= distance * distance;
+    };
+  }
+  else
+  {
+    // Ray through the event position; the tolerance grows with the depth in perspective.
+    vtkCamera * camera = renderer->GetActiveCamera();
+    const int * size = renderer->GetSize();
+    const double height = std::max(size[1], 1);
+    int displayPosition[2] = { 0 };
+    eventData->GetDisplayPosition(displayPosition);
+    double nearPoint[4] = { 0.0 };
+    double farPoint[4] = { 0.0 };
+    renderer->SetDisplayPoint(displayPosition[0], displayPosition[1], 0.0);
+    renderer->DisplayToWorld();
+    renderer->GetWorldPoint(nearPoint);
+    renderer->SetDisplayPoint(displayPosition[0], displayPosition[1], 1.0);
+    renderer->DisplayToWorld();
+    renderer->GetWorldPoint(farPoint);
+    if (nearPoint[3] == 0.0 || farPoint[3] == 0.0)
+    {
+      for (const Shape& shape : this->Shapes)
+      {
+        this->Candidates.insert(shape.Representation);
+      }
+      return;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+      nearPoint[i] /= nearPoint[3];
+      farPoint[i] /= farPoint[3];
+    }
+    parallel = camera->GetParallelProjection();
+    if (parallel)
+    {
+      std::copy(nearPoint, nearPoint + 3, origin);
+    }
+    else
+    {
+      camera->GetPosition(origin);
+    }
+    vtkMath::Subtract(farPoint, origin, direction);
+    vtkMath::Normalize(direction);
+    parallelMmPerPixel = 2.0 * camera->GetParallelScale() / height;
+    perspectiveMmPerPixel = 2.0 * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0) / height;
+    isNear = [&](const double * sphere)
+    {
+      const double relative[3] = { sphere[0] - origin[0], sphere[1] - origin[1], sphere[2] - origin[2] };
+      const double depth = vtkMath::Dot(relative, direction);
+      // Farthest depth of the sphere : the largest tolerance.
+      const double mmPerPixel = parallel ? parallelMmPerPixel
+                                         : perspectiveMmPerPixel * std::max(depth + sphere[3], 0.0);
+      const double distance = sphere[3] + this->TolerancePixels * mmPerPixel;
+      if (!parallel && depth + distance < 0.0)
+      {
+        return false; // Behind the camera
+      }
+      const double distance2 = vtkMath::Dot(relative, relative) - depth * depth;
+      return distance2 <= distance * distance;
+    };
+  }
+  
+  std::vector<int> stack;
+  stack.push_back(0);
+  while (!stack.empty())
+  {
+    const TreeNode& node = this->Tree[stack.back()];
+    stack.pop_back();
+    if (!isNear(node.Sphere))
+    {
+      continue;
+    }
+    if (node.Child >= 0)
+    {
+      stack.push_back(node.Child);
+      stack.push_back(node.Child + 1);
+      continue;
+    }
+    for (int i = node.First; i < node.First + node.Count; i++)
+    {
+      const Shape& shape = this->Shapes[this->ShapeOrder[i]];
+      if (isNear(shape.Sphere))
+      {
+        this->Candidates.insert(shape.Representation);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::Build()
+{
+  this->Tree.clear();
+  this->ShapeOrder.resize(this->Shapes.size());
+  for (size_t i = 0; i < this->Shapes.size(); i++)
+  {
+    this->ShapeOrder[i] = (int) i;
+  }
+  if (!this->Shapes.empty())
+  {
+    this->Tree.reserve(2 * this->Shapes.size());
+    this->Tree.emplace_back();
+    this->BuildNode(0, 0, (int) this->Shapes.size());
+    this->Refit();
+  }
+  this->TreeOutdated = false;
+  this->TreeMoved = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::BuildNode(int node, int first, int count)
+{
+  this->Tree[node].First = first;
+  this->Tree[node].Count = count;
+  this->Tree[node].Child = -1;
+  const int leafSize = 4;
+  if (count <= leafSize)
+  {
+    return;
+  }
+  // Median split of the centers along the largest extent.
+  double bounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  for (int i = first; i < first + count; i++)
+  {
+    const double * center = this->Shapes[this->ShapeOrder[i]].Sphere;
+    for (int j = 0; j < 3; j++)
+    {
+      bounds[2 * j] = std::min(bounds[2 * j], center[j]);
+      bounds[2 * j + 1] = std::max(bounds[2 * j + 1], center[j]);
+    }
+  }
+  int axis = 0;
+  for (int j = 1; j < 3; j++)
+  {
+    if (bounds[2 * j + 1] - bounds[2 * j] > bounds[2 * axis + 1] - bounds[2 * axis])
+    {
+      axis = j;
+    }
+  }
+  const int half = count / 2;
+  std::nth_element(this->ShapeOrder.begin() + first, this->ShapeOrder.begin() + first + half,
+                   this->ShapeOrder.begin() + first + count,
+                   [this, axis](int a, int b) { return this->Shapes[a].Sphere[axis] < this->Shapes[b].Sphere[axis]; });
+  const int child = (int) this->Tree.size();
+  this->Tree.emplace_back();
+  this->Tree.emplace_back();
+  this->Tree[node].Child = child;
+  this->BuildNode(child, first, half);
+  this->BuildNode(child + 1, first + half, count - half);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::Refit()
+{
+  // Children are after their parent.
+  for (int node = (int) this->Tree.size() - 1; node >= 0; node--)
+  {
+    this->FitNode(node);
+  }
+  this->TreeMoved = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerShapeSpatialIndex::FitNode(int node)
+{
+  TreeNode& treeNode = this->Tree[node];
+  auto forEachSphere = [&](auto&& visit)
+  {
+    if (treeNode.Child >= 0)
+    {
+      visit(this->Tree[treeNode.Child].Sphere);
+      visit(this->Tree[treeNode.Child + 1].Sphere);
+      return;
+    }
+    for (int i = treeNode.First; i < treeNode.First + treeNode.Count; i++)
+    {
+      visit(this->Shapes[this->ShapeOrder[i]].Sphere);
+    }
+  };
+  // Centered on the bounds of the spheres, enclosing all of them.
+  double bounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  forEachSphere([&bounds](const double * sphere)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      bounds[2 * j] = std::min(bounds[2 * j], sphere[j] - sphere[3]);
+      bounds[2 * j + 1] = std::max(bounds[2 * j + 1], sphere[j] + sphere[3]);
+    }
+  });
+  double * enclosing = treeNode.Sphere;
+  enclosing[3] = 0.0;
+  for (int j = 0; j < 3; j++)
+  {
+    enclosing[j] = (bounds[2 * j] + bounds[2 * j + 1]) / 2.0;
+  }
+  forEachSphere([enclosing](const double * sphere)
+  {
+    enclosing[3] = std::max(enclosing[3], std::sqrt(vtkMath::Distance2BetweenPoints(sphere, enclosing)) + sphere[3]);
+  });
+}
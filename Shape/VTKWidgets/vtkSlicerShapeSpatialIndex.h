@@ -0,0 +1,125 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#ifndef __vtkslicershapespatialindex_h_
+#define __vtkslicershapespatialindex_h_
+
+#include "vtkSlicerShapeModuleVTKWidgetsExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class vtkMRMLAbstractViewNode;
+class vtkMRMLInteractionEventData;
+class vtkMRMLMarkupsShapeNode;
+class vtkRenderer;
+
+/**
+ * Bounding sphere hierarchy over the shapes of a view, in world coordinates.
+ *
+ * Shape widgets query it to reject mouse moves far from their shape without
+ * searching their control points and geometry. The candidates of an event are
+ * computed once, by the first widget asking, and shared by all widgets of the view.
+ * Moved shapes only refit the hierarchy; it is rebuilt if shapes are added or removed.
+ */
+class VTK_SLICER_SHAPE_MODULE_VTKWIDGETS_EXPORT vtkSlicerShapeSpatialIndex
+: public vtkObject
+{
+public:
+  static vtkSlicerShapeSpatialIndex* New();
+  vtkTypeMacro(vtkSlicerShapeSpatialIndex, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Shared by all shape representations of a view, created on demand.
+  static vtkSlicerShapeSpatialIndex* GetViewIndex(vtkMRMLAbstractViewNode * viewNode);
+  /// Index of a view if it exists.
+  static vtkSlicerShapeSpatialIndex* FindViewIndex(vtkMRMLAbstractViewNode * viewNode);
+  /// Index the bounding sphere of the shape if indexed is true and the shape is defined,
+  /// else remove the representation.
+  static void UpdateViewShape(vtkMRMLAbstractViewNode * viewNode, vtkObject * representation,
+                              vtkMRMLMarkupsShapeNode * shapeNode, bool indexed);
+  static void RemoveViewShape(vtkMRMLAbstractViewNode * viewNode, vtkObject * representation);
+  static bool IsViewShapeNearEvent(vtkMRMLAbstractViewNode * viewNode, vtkObject * representation,
+                                   vtkMRMLInteractionEventData * eventData, vtkRenderer * renderer);
+  /// Bounding sphere of the shape of a representation.
+  void SetShape(vtkObject * representation, const double * center, double radius);
+  /// Events of a representation that is not indexed are never rejected.
+  /// Returns true if no shape is left; RemoveViewShape() then deletes the index of the view.
+  bool RemoveShape(vtkObject * representation);
+  int GetNumberOfShapes();
+  /// True if the shape of the representation may be closer than TolerancePixels
+  /// to the event position, or if it is not indexed.
+  bool IsShapeNearEvent(vtkObject * representation, vtkMRMLInteractionEventData * eventData,
+                        vtkRenderer * renderer);
+
+  /// Distance around the shapes for control point glyphs and picking. 60 by default.
+  vtkSetClampMacro(TolerancePixels, double, 0.0, 1000.0);
+  vtkGetMacro(TolerancePixels, double);
+
+protected:
+  vtkSlicerShapeSpatialIndex();
+  ~vtkSlicerShapeSpatialIndex() override;
+
+  struct Shape
+  {
+    vtkObject * Representation = nullptr;
+    double Sphere[4] = { 0.0 }; // Center, radius
+  };
+  struct TreeNode
+  {
+    double Sphere[4] = { 0.0 };
+    int Child = -1; // First child, the second one follows; -1 for a leaf
+    int First = 0; // Leaf : range in ShapeOrder
+    int Count = 0;
+  };
+  void Build();
+  void Refit();
+  void BuildNode(int node, int first, int count);
+  void FitNode(int node);
+  void FindCandidates(vtkMRMLInteractionEventData * eventData, vtkRenderer * renderer);
+
+  vtkWeakPointer<vtkMRMLAbstractViewNode> ViewNode;
+  double TolerancePixels { 60.0 };
+  std::vector<Shape> Shapes;
+  std::unordered_map<vtkObject*, int> ShapeIndices;
+  std::vector<int> ShapeOrder; // Shapes by leaf
+  std::vector<TreeNode> Tree; // Children after their parent
+  bool TreeOutdated { false }; // Shapes added or removed
+  bool TreeMoved { false }; // Shapes moved
+
+  // Candidates of the last event.
+  std::unordered_set<vtkObject*> Candidates;
+  const void * CandidatesEventData = nullptr;
+  double CandidatesPosition[5] = { 0.0 }; // Display x, y, world x, y, z
+  vtkMTimeType CandidatesCameraTime { 0 };
+  vtkMTimeType CandidatesIndexTime { 0 };
+
+private:
+  vtkSlicerShapeSpatialIndex(const vtkSlicerShapeSpatialIndex&) = delete;
+  void operator=(const vtkSlicerShapeSpatialIndex&) = delete;
+};
+
+#endif // __vtkslicershapespatialindex_h_
@@ -23,11 +23,15 @@
 // Liver Markups VTKWidgets include
 #include "vtkSlicerShapeRepresentation3D.h"
 #include "vtkSlicerShapeRepresentation2D.h"
+#include "vtkSlicerShapeSpatialIndex.h"
 
 // VTK includes
 #include <vtkObjectFactory.h>
 
 // MRML includes
+#include <vtkMRMLInteractionEventData.h>
+#include <vtkMRMLInteractionNode.h>
+#include <vtkMRMLMarkupsDisplayNode.h>
 #include <vtkMRMLSliceNode.h>
 
 //------------------------------------------------------------------------------
@@ -78,3 +82,21 @@ vtkSlicerMarkupsWidget* vtkSlicerShapeWidget::CreateInstance() const
 #endif
   return result;
 }
+
+//------------------------------------------------------------------------------
+bool vtkSlicerShapeWidget::CanProcessInteractionEvent(vtkMRMLInteractionEventData* eventData, double &distance2)
+{
+  vtkSlicerMarkupsWidgetRepresentation * rep = vtkSlicerMarkupsWidgetRepresentation::SafeDownCast(this->WidgetRep);
+  vtkMRMLInteractionNode * interactionNode = this->GetInteractionNode();
+  vtkMRMLMarkupsDisplayNode * displayNode = this->GetMarkupsDisplayNode();
+  // Placing, dragging and interaction handles are not bound to the shape.
+  if (rep && eventData && eventData->GetType() == vtkCommand::MouseMoveEvent
+    && this->WidgetState == WidgetStateIdle
+    && !(interactionNode && interactionNode->GetCurrentInteractionMode() == vtkMRMLInteractionNode::Place)
+    && !(displayNode && displayNode->GetHandlesInteractive())
+    && !vtkSlicerShapeSpatialIndex::IsViewShapeNearEvent(rep->GetViewNode(), rep, eventData, this->Renderer))
+  {
+    return false;
+  }
+  return this->Superclass::CanProcessInteractionEvent(eventData, distance2);
+}
@@ -40,6 +40,10 @@ public:
   VTK_NEWINSTANCE
   virtual vtkSlicerMarkupsWidget* CreateInstance() const override;
 
+  /// Mouse moves far from the shape are rejected with the view's spatial index,
+  /// without searching the control points and the geometry.
+  bool CanProcessInteractionEvent(vtkMRMLInteractionEventData* eventData, double &distance2) override;
+
 protected:
   vtkSlicerShapeWidget();
   ~vtkSlicerShapeWidget() override;
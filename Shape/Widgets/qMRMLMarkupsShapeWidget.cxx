@@ -29,6 +29,14 @@
 
 #include <qSlicerCoreApplication.h>
 
+#include <QTimer>
+
+namespace
+{
+  // Idle time after the last change before it is applied.
+  const int DeferredUpdateDelay = 250; // ms
+}
+
 // --------------------------------------------------------------------------
 class qMRMLMarkupsShapeWidgetPrivate:
   public Ui_qMRMLMarkupsShapeWidget
@@ -43,6 +51,14 @@ public:
   void setupUi(qMRMLMarkupsShapeWidget*);
 
   vtkWeakPointer<vtkMRMLMarkupsShapeNode> MarkupsShapeNode;
+  
+  // Changes are collected here and applied at once by applyPendingChanges().
+  QTimer DeferredUpdateTimer;
+  bool ResolutionPending { false };
+  double PendingResolution { 0.0 };
+  bool ResliceNodePending { false };
+  vtkWeakPointer<vtkMRMLNode> PendingResliceNode;
+  bool ReslicePending { false };
 };
 
 // --------------------------------------------------------------------------
@@ -70,6 +86,10 @@ void qMRMLMarkupsShapeWidgetPrivate::setupUi(qMRMLMarkupsShapeWidget* widget)
   this->drawModeComboBox->addItem("Intersection");
   this->drawModeComboBox->addItem("Projection");
   this->resliceInputSelector->setMRMLScene(widget->mrmlScene());
+  // valueChanged() on release or keyboard edit, valueIsChanging() while dragging.
+  this->resolutionSliderWidget->setTracking(false);
+  this->DeferredUpdateTimer.setSingleShot(true);
+  this->DeferredUpdateTimer.setInterval(DeferredUpdateDelay);
   
   QObject::connect(this->shapeNameComboBox, SIGNAL(currentIndexChanged(int)),
                    q, SLOT(onShapeChanged(int)));
@@ -79,10 +99,14 @@ void qMRMLMarkupsShapeWidgetPrivate::setupUi(qMRMLMarkupsShapeWidget* widget)
                    q, SLOT(onDrawModeChanged()));
   QObject::connect(this->resolutionSliderWidget, SIGNAL(valueChanged(double)),
                    q, SLOT(onResolutionChanged(double)));
+  QObject::connect(this->resolutionSliderWidget, SIGNAL(valueIsChanging(double)),
+                   q, SLOT(onResolutionChanging(double)));
   QObject::connect(this->resliceInputSelector, SIGNAL(currentNodeChanged(vtkMRMLNode*)),
                    q, SLOT(onResliceNodeChanged(vtkMRMLNode*)));
   QObject::connect(this->reslicePushButton, SIGNAL(clicked()),
                    q, SLOT(onResliceButtonClicked()));
+  QObject::connect(&this->DeferredUpdateTimer, SIGNAL(timeout()),
+                   q, SLOT(applyPendingChanges()));
 }
 
 // --------------------------------------------------------------------------
@@ -138,6 +162,8 @@ void qMRMLMarkupsShapeWidget::setMRMLMarkupsNode(vtkMRMLMarkupsNode* markupsNode
 {
   Q_D(qMRMLMarkupsShapeWidget);
 
+  // Pending changes belong to the previous node.
+  this->applyPendingChanges();
   d->MarkupsShapeNode = vtkMRMLMarkupsShapeNode::SafeDownCast(markupsNode);
   this->setEnabled(markupsNode != nullptr);
   if (d->MarkupsShapeNode)
@@ -191,6 +217,21 @@ void qMRMLMarkupsShapeWidget::onDrawModeChanged()
   d->MarkupsShapeNode->UpdateScene(this->mrmlScene());
 }
 
+// --------------------------------------------------------------------------
+void qMRMLMarkupsShapeWidget::onResolutionChanging(double value)
+{
+  Q_D(qMRMLMarkupsShapeWidget);
+  
+  if (!d->MarkupsShapeNode)
+  {
+    return;
+  }
+  // Applied when the slider pauses, or on release.
+  d->ResolutionPending = true;
+  d->PendingResolution = value;
+  d->DeferredUpdateTimer.start();
+}
+
 // --------------------------------------------------------------------------
 void qMRMLMarkupsShapeWidget::onResolutionChanged(double value)
 {
@@ -200,8 +241,9 @@ void qMRMLMarkupsShapeWidget::onResolutionChanged(double value)
   {
     return;
   }
-  d->MarkupsShapeNode->SetResolution(value);
-  d->MarkupsShapeNode->UpdateScene(this->mrmlScene());
+  d->ResolutionPending = true;
+  d->PendingResolution = value;
+  this->applyPendingChanges();
 }
 
 // --------------------------------------------------------------------------
@@ -213,8 +255,9 @@ void qMRMLMarkupsShapeWidget::onResliceNodeChanged(vtkMRMLNode * node)
   {
     return;
   }
-  d->MarkupsShapeNode->SetResliceNode(node);
-  d->MarkupsShapeNode->UpdateScene(this->mrmlScene());
+  d->ResliceNodePending = true;
+  d->PendingResliceNode = node;
+  d->DeferredUpdateTimer.start();
 }
 
 // --------------------------------------------------------------------------
@@ -226,6 +269,41 @@ void qMRMLMarkupsShapeWidget::onResliceButtonClicked()
   {
     return;
   }
-  d->MarkupsShapeNode->ResliceToControlPoints();
+  d->ReslicePending = true;
+  d->DeferredUpdateTimer.start();
+}
+
+// --------------------------------------------------------------------------
+void qMRMLMarkupsShapeWidget::applyPendingChanges()
+{
+  Q_D(qMRMLMarkupsShapeWidget);
+  
+  d->DeferredUpdateTimer.stop();
+  const bool resolutionPending = d->ResolutionPending;
+  const bool resliceNodePending = d->ResliceNodePending;
+  const bool reslicePending = d->ReslicePending;
+  d->ResolutionPending = false;
+  d->ResliceNodePending = false;
+  d->ReslicePending = false;
+  if (!d->MarkupsShapeNode || !(resolutionPending || resliceNodePending || reslicePending))
+  {
+    return;
+  }
+  {
+    // A single modified event for all changes.
+    MRMLNodeModifyBlocker blocker(d->MarkupsShapeNode);
+    if (resolutionPending)
+    {
+      d->MarkupsShapeNode->SetResolution(d->PendingResolution);
+    }
+    if (resliceNodePending)
+    {
+      d->MarkupsShapeNode->SetResliceNode(d->PendingResliceNode);
+    }
+  }
+  if (reslicePending)
+  {
+    d->MarkupsShapeNode->ResliceToControlPoints();
+  }
   d->MarkupsShapeNode->UpdateScene(this->mrmlScene());
 }
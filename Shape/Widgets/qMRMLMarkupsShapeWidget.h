@@ -63,9 +63,13 @@ public slots:
   void onShapeChanged(int shapeName);
   void onRadiusModeChanged();
   void onDrawModeChanged();
+  void onResolutionChanging(double value);
   void onResolutionChanged(double value);
   void onResliceNodeChanged(vtkMRMLNode * node);
   void onResliceButtonClicked();
+  /// Resolution and reslice changes are coalesced, and applied here in one update
+  /// on slider release or after a short idle time.
+  void applyPendingChanges();
 
 protected:
   void setup();
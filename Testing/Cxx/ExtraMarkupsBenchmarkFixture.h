@@ -0,0 +1,215 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#ifndef __ExtraMarkupsBenchmarkFixture_h_
+#define __ExtraMarkupsBenchmarkFixture_h_
+
+// Extension testing includes
+#include "ExtraMarkupsBenchmarkResults.h"
+
+// Markups includes
+#include <vtkSlicerMarkupsLogic.h>
+
+// Slicer includes
+#include <vtkSlicerApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLAbstractLogic.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceNode.h>
+#include <vtkMRMLViewNode.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Scene, logics, views and results of a module benchmark.
+//
+// Common arguments, all optional :
+//  --output file      : results as CSV if file ends with .csv, else as JSON. Printed if not set.
+//  --max-mean-ms T    : fail if the mean time of a stage exceeds T milliseconds.
+class ExtraMarkupsBenchmarkFixture
+{
+public:
+  // module : name written in JSON output.
+  // parameters : integer arguments of the benchmark, with their default values.
+  ExtraMarkupsBenchmarkFixture(const std::string& module, const std::map<std::string, int>& parameters)
+    : Parameters(parameters)
+    , Results(module)
+  {
+    // Logic and scene, as in the application.
+    this->ApplicationLogic->SetMRMLScene(this->Scene);
+    this->MarkupsLogic->SetMRMLApplicationLogic(this->ApplicationLogic);
+    this->MarkupsLogic->SetMRMLScene(this->Scene);
+    this->ApplicationLogic->SetModuleLogic("Markups", this->MarkupsLogic);
+  }
+
+  // Returns false on an unknown or incomplete argument.
+  bool ParseArguments(int argc, char * argv[])
+  {
+    for (int i = 1; i < argc; i = i + 2)
+    {
+      const std::string argument = argv[i];
+      if (argument.compare(0, 2, "--") != 0 || i + 1 >= argc)
+      {
+        std::cerr << "Invalid argument : " << argument << std::endl;
+        return false;
+      }
+      const std::string name = argument.substr(2);
+      if (name == "output")
+      {
+        this->OutputFileName = argv[i + 1];
+        continue;
+      }
+      if (name == "max-mean-ms")
+      {
+        this->MaximumMeanMs = std::atof(argv[i + 1]);
+        continue;
+      }
+      if (this->Parameters.find(name) == this->Parameters.end())
+      {
+        std::cerr << "Unknown argument : " << argument << std::endl;
+        return false;
+      }
+      this->Parameters[name] = std::max(1, std::atoi(argv[i + 1]));
+    }
+    return true;
+  }
+
+  int GetParameter(const std::string& name)
+  {
+    return this->Parameters[name];
+  }
+
+  // The module logic observes the scene, with the application logic.
+  void SetUpModuleLogic(vtkMRMLAbstractLogic * logic)
+  {
+    logic->SetMRMLApplicationLogic(this->ApplicationLogic);
+    logic->SetMRMLScene(this->Scene);
+  }
+
+  // One 3D view and the slice views, axial, sagittal and coronal in turn,
+  // with offscreen render windows.
+  void CreateViews(int numberOfSliceViews)
+  {
+    this->ViewNode = vtkMRMLViewNode::SafeDownCast(this->Scene->AddNewNodeByClass("vtkMRMLViewNode"));
+    this->ViewNode->SetLayoutName("1");
+    this->ViewRenderer = this->CreateRenderer();
+    for (int i = 0; i < numberOfSliceViews; i++)
+    {
+      vtkMRMLSliceNode * sliceNode = vtkMRMLSliceNode::SafeDownCast(this->Scene->AddNewNodeByClass("vtkMRMLSliceNode"));
+      sliceNode->SetLayoutName(("Slice" + std::to_string(i)).c_str());
+      sliceNode->SetDimensions(512, 512, 1);
+      sliceNode->SetFieldOfView(300.0, 300.0, 1.0);
+      const char * orientation[3] = { "Axial", "Sagittal", "Coronal" };
+      sliceNode->SetOrientation(orientation[i % 3]);
+      sliceNode->UpdateMatrices();
+      this->SliceNodes.push_back(sliceNode);
+      this->SliceRenderers.push_back(this->CreateRenderer());
+    }
+  }
+
+  // view : index of a slice view, or -1 for the 3D view.
+  vtkMRMLAbstractViewNode * GetViewNode(int view)
+  {
+    return (view >= 0) ? static_cast<vtkMRMLAbstractViewNode*>(this->SliceNodes[view]) : this->ViewNode;
+  }
+  vtkRenderer * GetRenderer(int view)
+  {
+    return (view >= 0) ? this->SliceRenderers[view].GetPointer() : this->ViewRenderer.GetPointer();
+  }
+
+  // Write the results, then compare them to the maximum mean time.
+  // Returns EXIT_SUCCESS or EXIT_FAILURE.
+  int WriteResults()
+  {
+    if (this->OutputFileName.empty())
+    {
+      this->Results.WriteJSON(std::cout, this->Parameters);
+    }
+    else
+    {
+      std::ofstream output(this->OutputFileName.c_str());
+      if (!output.is_open())
+      {
+        std::cerr << "Cannot write " << this->OutputFileName << std::endl;
+        return EXIT_FAILURE;
+      }
+      const std::string extension = ".csv";
+      const bool csv = this->OutputFileName.size() >= extension.size()
+        && this->OutputFileName.compare(this->OutputFileName.size() - extension.size(),
+                                        extension.size(), extension) == 0;
+      if (csv)
+      {
+        this->Results.WriteCSV(output);
+      }
+      else
+      {
+        this->Results.WriteJSON(output, this->Parameters);
+      }
+    }
+    if (this->MaximumMeanMs > 0.0 && !this->Results.CheckMaximumMean(this->MaximumMeanMs, std::cerr))
+    {
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  vtkNew<vtkMRMLScene> Scene;
+  vtkNew<vtkSlicerApplicationLogic> ApplicationLogic;
+  vtkNew<vtkSlicerMarkupsLogic> MarkupsLogic;
+  std::map<std::string, int> Parameters;
+  std::string OutputFileName;
+  double MaximumMeanMs { 0.0 };
+  ExtraMarkupsBenchmarkResults Results;
+
+  vtkMRMLViewNode * ViewNode { nullptr };
+  std::vector<vtkMRMLSliceNode*> SliceNodes;
+
+private:
+  vtkSmartPointer<vtkRenderer> CreateRenderer()
+  {
+    vtkNew<vtkRenderer> renderer;
+    vtkNew<vtkRenderWindow> renderWindow;
+    renderWindow->SetOffScreenRendering(1);
+    renderWindow->SetSize(512, 512);
+    renderWindow->AddRenderer(renderer);
+    this->RenderWindows.push_back(renderWindow.GetPointer());
+    return vtkSmartPointer<vtkRenderer>(renderer.GetPointer());
+  }
+
+  std::vector<vtkSmartPointer<vtkRenderWindow>> RenderWindows;
+  vtkSmartPointer<vtkRenderer> ViewRenderer;
+  std::vector<vtkSmartPointer<vtkRenderer>> SliceRenderers;
+};
+
+#endif // __ExtraMarkupsBenchmarkFixture_h_
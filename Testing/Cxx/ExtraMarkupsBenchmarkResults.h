@@ -0,0 +1,118 @@
+/*==============================================================================
+
+  Copyright (c) The Intervention Centre
+  Oslo University Hospital, Oslo, Norway. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Rafael Palomar (The Intervention Centre,
+  Oslo University Hospital) and was supported by The Research Council of Norway
+  through the ALive project (grant nr. 311393).
+
+==============================================================================*/
+
+#ifndef __ExtraMarkupsBenchmarkResults_h_
+#define __ExtraMarkupsBenchmarkResults_h_
+
+// STD includes
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+
+//----------------------------------------------------------------------------
+// Call count, cumulative and maximum time, by stage and markups type.
+// Shared by the module benchmarks, so that their CSV and JSON outputs are the same.
+class ExtraMarkupsBenchmarkResults
+{
+public:
+  // module : name written in JSON output.
+  explicit ExtraMarkupsBenchmarkResults(const std::string& module)
+    : Module(module)
+  {
+  }
+
+  void Add(const std::string& stage, const std::string& shape, double seconds)
+  {
+    Timing& timing = this->Timings[std::make_pair(stage, shape)];
+    timing.Calls++;
+    timing.Total += seconds;
+    timing.Maximum = std::max(timing.Maximum, seconds);
+  }
+
+  void WriteCSV(std::ostream& os) const
+  {
+    os << "stage,shape,calls,total_ms,mean_ms,max_ms\n";
+    for (const auto& item : this->Timings)
+    {
+      const Timing& timing = item.second;
+      os << item.first.first << "," << item.first.second << "," << timing.Calls << ","
+         << timing.Total * 1000.0 << "," << (timing.Total * 1000.0 / timing.Calls) << ","
+         << timing.Maximum * 1000.0 << "\n";
+    }
+  }
+
+  void WriteJSON(std::ostream& os, const std::map<std::string, int>& parameters) const
+  {
+    os << "{\n  \"module\": \"" << this->Module << "\",\n  \"parameters\": {";
+    bool first = true;
+    for (const auto& parameter : parameters)
+    {
+      os << (first ? "" : ", ") << "\"" << parameter.first << "\": " << parameter.second;
+      first = false;
+    }
+    os << "},\n  \"results\": [";
+    first = true;
+    for (const auto& item : this->Timings)
+    {
+      const Timing& timing = item.second;
+      os << (first ? "\n" : ",\n")
+         << "    {\"stage\": \"" << item.first.first << "\", \"shape\": \"" << item.first.second
+         << "\", \"calls\": " << timing.Calls
+         << ", \"total_ms\": " << timing.Total * 1000.0
+         << ", \"mean_ms\": " << (timing.Total * 1000.0 / timing.Calls)
+         << ", \"max_ms\": " << timing.Maximum * 1000.0 << "}";
+      first = false;
+    }
+    os << "\n  ]\n}\n";
+  }
+
+  // Report the stages whose mean time exceeds maximumMeanMs milliseconds.
+  // Returns false if there is any.
+  bool CheckMaximumMean(double maximumMeanMs, std::ostream& os) const
+  {
+    bool passed = true;
+    for (const auto& item : this->Timings)
+    {
+      const Timing& timing = item.second;
+      const double meanMs = timing.Total * 1000.0 / timing.Calls;
+      if (meanMs > maximumMeanMs)
+      {
+        os << "Too slow : " << item.first.first << ", " << item.first.second << " : "
+           << meanMs << " ms > " << maximumMeanMs << " ms\n";
+        passed = false;
+      }
+    }
+    return passed;
+  }
+
+private:
+  struct Timing
+  {
+    int Calls { 0 };
+    double Total { 0.0 };
+    double Maximum { 0.0 };
+  };
+  std::string Module;
+  std::map<std::pair<std::string, std::string>, Timing> Timings;
+};
+
+#endif // __ExtraMarkupsBenchmarkResults_h_